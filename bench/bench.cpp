@@ -0,0 +1,259 @@
+/* *********************************************************** *
+ * bench.cpp
+ * Microbenchmarks for the game libraries and the agents.
+ *
+ * Usage: twoplayergames-bench [--format=json|csv] [--min-time=<ms>] [<filter>]
+ * Runs every benchmark whose name contains the filter and writes one line per benchmark,
+ * as JSON objects (default) or CSV. All positions and agents are seeded, so the work per
+ * operation is the same in every run.
+ * *********************************************************** */
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "twoplayergames/Random.h"
+#include "twoplayergames/agent/MCTSPlayer.h"
+#include "twoplayergames/agent/MinimaxPlayer.h"
+
+#include "connectfour/ConnectFour.h"
+#include "connectfour/Solver.h"
+#include "tictactoe/PerfectPlayer.h"
+#include "tictactoe/TicTacToe.h"
+
+namespace {
+
+struct Result {
+    std::string name;
+    std::uint64_t operations;
+    double seconds;
+};
+
+// A batch runs some work and returns how many operations it did.
+using Batch = std::function<std::uint64_t()>;
+
+struct Benchmark {
+    std::string name;
+    Batch batch;
+};
+
+// results of the measured code end up here, so the compiler can not drop the work
+volatile std::uint64_t sink;
+
+Result measure(const Benchmark& benchmark, std::chrono::milliseconds minTime) {
+    using Clock = std::chrono::steady_clock;
+    benchmark.batch(); // warm up caches, arenas and transposition tables
+    std::uint64_t operations{ 0 };
+    const auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    do {
+        operations += benchmark.batch();
+        elapsed = Clock::now() - start;
+    } while (elapsed < minTime);
+    return Result{ benchmark.name, operations, std::chrono::duration<double>(elapsed).count() };
+}
+
+// Non-terminal positions reached by random moves, the same in every run.
+template<class GameState>
+std::vector<GameState> randomPositions(int count, int maxPlies) {
+    play::Xoshiro256 random{ 0x5eed };
+    std::vector<GameState> positions;
+    while (static_cast<int>(positions.size()) < count) {
+        auto game = GameState::newGame();
+        const int plies = static_cast<int>(random.below(static_cast<std::uint32_t>(maxPlies + 1)));
+        for (int ply = 0; ply < plies && !isGameOver(game); ++ply)
+            playRandomMove(game, static_cast<std::uint32_t>(random() >> 32));
+        if (!isGameOver(game))
+            positions.push_back(game);
+    }
+    return positions;
+}
+
+template<class GameState>
+std::vector<Benchmark> moveGenerationBenchmarks(const std::string& game, const std::vector<GameState>& positions) {
+    return {
+        { game + "/applyMove", [&positions] {
+            std::uint64_t operations{ 0 };
+            for (const auto& position : positions) {
+                for (const auto& move : listLegalMoves(position)) {
+                    sink = sink + hashOf(applyMove(move, position));
+                    ++operations;
+                }
+            }
+            return operations;
+        } },
+        { game + "/listLegalMoves", [&positions] {
+            for (const auto& position : positions)
+                sink = sink + listLegalMoves(position).size();
+            return static_cast<std::uint64_t>(positions.size());
+        } },
+    };
+}
+
+template<class GameState>
+Batch checkWinBatch(const std::vector<GameState>& positions) {
+    return [&positions] {
+        std::uint64_t operations{ 0 };
+        for (const auto& position : positions) {
+            for (int col = 0; col < position.board().columns(); ++col)
+                sink = sink + position.board().checkWin(col);
+            operations += position.board().columns();
+        }
+        return operations;
+    };
+}
+
+// Every position is searched by a new agent, so no search profits from the one before.
+template<class GameState, class CreateAgent, class OperationsOf>
+Batch agentBatch(const std::vector<GameState>& positions, CreateAgent createAgent, OperationsOf operationsOf) {
+    return [&positions, createAgent, operationsOf] {
+        std::uint64_t operations{ 0 };
+        for (const auto& position : positions) {
+            auto agent = createAgent();
+            sink = sink + agent.selectMoves(position).size();
+            operations += operationsOf(agent);
+        }
+        return operations;
+    };
+}
+
+std::vector<Benchmark> allBenchmarks() {
+    namespace c4 = play::connectfour;
+    namespace ttt = play::tictactoe;
+    using C4Fixed = c4::FixedGameState<6, 7>;
+    using C4Mcts = play::agent::MCTSPlayer<c4::GameState, c4::Move, 2000>;
+    using C4Minimax = play::agent::MinimaxPlayer<c4::GameState, c4::Move, c4::ConnectFourEvaluator_Streaks>;
+    using TttMcts = play::agent::MCTSPlayer<ttt::GameState, ttt::Move, 2000>;
+    using TttMinimax = play::agent::MinimaxPlayer<ttt::GameState, ttt::Move>;
+
+    static const auto c4Positions = randomPositions<c4::GameState>(256, 30);
+    static const auto c4SearchPositions = std::vector<c4::GameState>(c4Positions.begin(), c4Positions.begin() + 4);
+    // early positions take the solver minutes
+    static const auto c4SolverPositions = [] {
+        std::vector<c4::GameState> positions;
+        for (const auto& position : c4Positions)
+            if (c4::Board::countCells(position.board().occupied()) >= 14 && positions.size() < 4)
+                positions.push_back(position);
+        return positions;
+    }();
+    static const auto tttPositions = randomPositions<ttt::GameState>(256, 6);
+    static const auto tttSearchPositions = std::vector<ttt::GameState>{ ttt::GameState::newGame() };
+
+    std::vector<Benchmark> benchmarks;
+    for (auto& b : moveGenerationBenchmarks("connectfour", c4Positions))
+        benchmarks.push_back(std::move(b));
+    benchmarks.push_back({ "connectfour/checkWin", checkWinBatch(c4Positions) });
+    benchmarks.push_back({ "connectfour/evaluateStreaks", [] {
+        c4::ConnectFourEvaluator_Streaks evaluator;
+        for (const auto& position : c4Positions)
+            sink = sink + static_cast<std::uint64_t>(evaluator.evaluateGameState(position));
+        return static_cast<std::uint64_t>(c4Positions.size());
+    } });
+    benchmarks.push_back({ "connectfour/evaluateThreats", [] {
+        c4::ConnectFourEvaluator_Threats evaluator;
+        for (const auto& position : c4Positions)
+            sink = sink + static_cast<std::uint64_t>(evaluator.evaluateGameState(position));
+        return static_cast<std::uint64_t>(c4Positions.size());
+    } });
+    benchmarks.push_back({ "connectfour/mctsPlayouts", agentBatch(c4SearchPositions,
+        [] { return C4Mcts{ 1, play::agent::ParallelMCTS::RootParallel, 1 }; }, [](const C4Mcts&) { return std::uint64_t{ 2000 }; }) });
+    benchmarks.push_back({ "connectfour/minimaxNodes", agentBatch(c4SearchPositions,
+        [] { return C4Minimax{ 7, 1 }; }, [](const C4Minimax& agent) { return agent.nodesSearched(); }) });
+    benchmarks.push_back({ "connectfour/solverNodes", agentBatch(c4SolverPositions,
+        [] { return c4::Solver{ 4 }; }, [](const c4::Solver& agent) { return agent.nodesSearched(); }) });
+
+    // the same game with the board size known to the compiler
+    static const auto c4FixedPositions = randomPositions<C4Fixed>(256, 30);
+    for (auto& b : moveGenerationBenchmarks("connectfour7x6", c4FixedPositions))
+        benchmarks.push_back(std::move(b));
+    benchmarks.push_back({ "connectfour7x6/checkWin", checkWinBatch(c4FixedPositions) });
+
+    for (auto& b : moveGenerationBenchmarks("tictactoe", tttPositions))
+        benchmarks.push_back(std::move(b));
+    benchmarks.push_back({ "tictactoe/mctsPlayouts", agentBatch(tttSearchPositions,
+        [] { return TttMcts{ 1, play::agent::ParallelMCTS::RootParallel, 1 }; }, [](const TttMcts&) { return std::uint64_t{ 2000 }; }) });
+    benchmarks.push_back({ "tictactoe/minimaxNodes", agentBatch(tttSearchPositions,
+        [] { return TttMinimax{ -1, 0 }; }, [](const TttMinimax& agent) { return agent.nodesSearched(); }) });
+    benchmarks.push_back({ "tictactoe/perfectMoves", [] {
+        ttt::PerfectPlayer perfect;
+        for (const auto& position : tttPositions)
+            sink = sink + perfect.selectMoves(position).size();
+        return static_cast<std::uint64_t>(tttPositions.size());
+    } });
+    return benchmarks;
+}
+
+void printJson(const Result& result) {
+    std::cout << "{\"name\": \"" << result.name << "\", \"operations\": " << result.operations
+        << ", \"seconds\": " << result.seconds
+        << ", \"ns_per_op\": " << result.seconds * 1e9 / result.operations
+        << ", \"ops_per_second\": " << result.operations / result.seconds << "}\n";
+}
+
+void printCsv(const Result& result) {
+    std::cout << result.name << ',' << result.operations << ',' << result.seconds << ','
+        << result.seconds * 1e9 / result.operations << ',' << result.operations / result.seconds << '\n';
+}
+
+bool startsWith(const char* argument, const char* prefix) {
+    return std::strncmp(argument, prefix, std::strlen(prefix)) == 0;
+}
+
+// Reads a whole non-negative number of milliseconds, returns false for anything else.
+bool parseMilliseconds(const std::string& text, std::chrono::milliseconds& time) {
+    try {
+        std::size_t parsed{ 0 };
+        const long value = std::stol(text, &parsed);
+        if (parsed != text.size() || value < 0)
+            return false;
+        time = std::chrono::milliseconds{ value };
+        return true;
+    } catch (const std::logic_error&) { // std::invalid_argument or std::out_of_range
+        return false;
+    }
+}
+
+int usageError(const char* program) {
+    std::cerr << "Usage: " << program << " [--format=json|csv] [--min-time=<ms>] [<filter>]\n";
+    return 1;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    bool csv{ false };
+    std::chrono::milliseconds minTime{ 200 };
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        if (startsWith(argv[i], "--format=")) {
+            const std::string format = argv[i] + std::strlen("--format=");
+            if (format != "json" && format != "csv")
+                return usageError(argv[0]);
+            csv = format == "csv";
+        } else if (startsWith(argv[i], "--min-time=")) {
+            if (!parseMilliseconds(argv[i] + std::strlen("--min-time="), minTime))
+                return usageError(argv[0]);
+        } else if (startsWith(argv[i], "--")) {
+            return usageError(argv[0]);
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    if (csv)
+        std::cout << "name,operations,seconds,ns_per_op,ops_per_second\n";
+    for (const auto& benchmark : allBenchmarks()) {
+        if (benchmark.name.find(filter) == std::string::npos)
+            continue;
+        const auto result = measure(benchmark, minTime);
+        if (csv)
+            printCsv(result);
+        else
+            printJson(result);
+    }
+}
@@ -0,0 +1,50 @@
+/* *********************************************************** *
+ * book.cpp
+ * Generates a Connect Four opening book with the solver.
+ *
+ * Usage: twoplayergames-book <depth> <file> [--table=<MB>]
+ * Solves every position of the standard board with at most depth stones and writes their
+ * values and best moves to the book file, which play::game::OpeningBook maps. The solver
+ * needs minutes for the earliest positions, so deep books take hours; a larger
+ * transposition table (default 256 MB) helps.
+ * *********************************************************** */
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "twoplayergames/gameplay/OpeningBook.h"
+
+#include "connectfour/ConnectFour.h"
+#include "connectfour/Solver.h"
+
+int main(int argc, char* argv[]) {
+    namespace c4 = play::connectfour;
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <depth> <file> [--table=<MB>]\n";
+        return 1;
+    }
+    const int depth = std::stoi(argv[1]);
+    const std::string path = argv[2];
+    std::size_t tableMB{ 256 };
+    if (argc > 3 && std::strncmp(argv[3], "--table=", std::strlen("--table=")) == 0)
+        tableMB = std::stoul(argv[3] + std::strlen("--table="));
+
+    c4::Solver solver{ tableMB };
+    const auto start = std::chrono::steady_clock::now();
+    int analysed{ 0 };
+    const auto entries = play::game::generateOpeningBook<c4::GameState, c4::Move>(c4::GameState::newGame(), depth, [&](const c4::GameState& position) {
+        auto analysis = solver.analyse(position);
+        if (++analysed % 100 == 0)
+            std::cerr << analysed << " positions, " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s\n";
+        return analysis;
+    });
+    if (!play::game::writeOpeningBook(path, entries)) {
+        std::cerr << "Can not write " << path << '\n';
+        return 1;
+    }
+    std::cout << entries.size() << " positions in "
+        << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s\n";
+}
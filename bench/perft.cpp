@@ -0,0 +1,58 @@
+/* *********************************************************** *
+ * perft.cpp
+ * Counts the leaves of the game tree from the initial position.
+ *
+ * Usage: twoplayergames-perft <connectfour|connectfour7x6|tictactoe> <depth> [--divide]
+ * A negative depth counts to the end of every game. With --divide, the count below every
+ * first move is printed as well.
+ * *********************************************************** */
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "twoplayergames/gameplay/Perft.h"
+
+#include "connectfour/ConnectFour.h"
+#include "tictactoe/TicTacToe.h"
+
+namespace {
+
+template<class GameState, class Move>
+void runPerft(int depth, bool divide) {
+    const auto game = GameState::newGame();
+    if (divide) {
+        for (const auto& [move, count] : play::game::perftDivide<GameState, Move>(game, depth))
+            std::cout << move << ": " << count << '\n';
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const auto leaves = play::game::perft<GameState, Move>(game, depth);
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "depth " << depth << ": " << leaves << " leaves in " << seconds << " s ("
+        << leaves / seconds << " leaves/s)\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <connectfour|connectfour7x6|tictactoe> <depth> [--divide]\n";
+        return 1;
+    }
+    const std::string game = argv[1];
+    const int depth = std::stoi(argv[2]);
+    const bool divide = argc > 3 && std::strcmp(argv[3], "--divide") == 0;
+
+    if (game == "connectfour")
+        runPerft<play::connectfour::GameState, play::connectfour::Move>(depth, divide);
+    else if (game == "connectfour7x6")
+        runPerft<play::connectfour::FixedGameState<6, 7>, play::connectfour::Move>(depth, divide);
+    else if (game == "tictactoe")
+        runPerft<play::tictactoe::GameState, play::tictactoe::Move>(depth, divide);
+    else {
+        std::cerr << "Unknown game " << game << '\n';
+        return 1;
+    }
+}
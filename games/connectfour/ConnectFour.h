@@ -6,98 +6,528 @@
 #ifndef CONNECT_FOUR_H
 #define CONNECT_FOUR_H
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
 #include <vector>
 #include <iostream>
 #include "twoplayergames/gameplay/Player.h"
 #include "twoplayergames/gameplay/GameStateEvaluator.h"
+#include "twoplayergames/gameplay/MoveList.h"
+#include "twoplayergames/gameplay/Zobrist.h"
 
 namespace play::connectfour {
 
-class Board {
+using Move = int;
+
+// one move per column; the bitboard holds at most 32 columns (one row and the sentinel each)
+inline constexpr std::size_t maxLegalMoves = 32;
+using MoveList = play::game::MoveList<Move, maxLegalMoves>;
+
+namespace detail {
+// one bit per column, in the bottom row of the bitboard layout of Board
+constexpr std::uint64_t bottomRowOf(int rows, int columns) {
+    std::uint64_t bottomRow{ 0 };
+    for (int col = 0; col < columns; ++col)
+        bottomRow |= std::uint64_t{ 1 } << (col * (rows + 1));
+    return bottomRow;
+}
+}
+
+/* The size of a board is a policy of BasicBoard and BasicGameState:
+ *   FixedSize: dimensions known at compile time. The geometry of the bitboard is constant,
+ *     so the shifts of the win checks are immediates and the loops over the directions and
+ *     columns can be unrolled, and the states store nothing but their stones.
+ *   RuntimeSize: dimensions chosen when the board is created, e.g. by a user; the board
+ *     stores them.
+ */
+template<int Rows, int Columns>
+class FixedSize {
+    static_assert(Rows > 0 && Columns > 0 && (Rows + 1) * Columns <= 64, "the board has to fit into the 64-bit bitboard");
+public:
+    static constexpr std::size_t maxColumns = Columns;
+
+    static constexpr int rows() { return Rows; }
+    static constexpr int columns() { return Columns; }
+    static constexpr std::uint64_t bottomRow() { return bottomRowMask; }
+private:
+    static constexpr std::uint64_t bottomRowMask = detail::bottomRowOf(Rows, Columns);
+};
+
+class RuntimeSize {
 public:
-    Board(int rows = 6, int columns = 7);
+    static constexpr std::size_t maxColumns = maxLegalMoves;
+
+    // Throws std::invalid_argument unless rows > 0, columns > 0 and (rows + 1) * columns <= 64.
+    constexpr RuntimeSize(int rows = 6, int columns = 7) :
+        m_rows{ rows }, m_columns{ columns }, m_bottomRow{ detail::bottomRowOf(checkedRows(rows, columns), columns) } {
+    }
+
+    constexpr int rows() const { return m_rows; }
+    constexpr int columns() const { return m_columns; }
+    constexpr std::uint64_t bottomRow() const { return m_bottomRow; }
+private:
+    int m_rows, m_columns;
+    std::uint64_t m_bottomRow;
+
+    // the same limit as the static_assert of FixedSize, checked before any shift uses the size
+    static constexpr int checkedRows(int rows, int columns) {
+        if (rows <= 0 || columns <= 0 || (rows + 1) * columns > 64)
+            throw std::invalid_argument("the board has to fit into the 64-bit bitboard: (rows + 1) * columns <= 64");
+        return rows;
+    }
+};
+
+template<class Size>
+class BasicBoard : private Size {
+    /* Bitboard representation of the board.
+     * Each column occupies rows + 1 consecutive bits (bottom row first); the extra bit on
+     * top of each column is a sentinel that always stays empty, so shifts in any direction
+     * can not wrap a run of stones from one column into the next. The stones of each
+     * player are stored in one 64-bit mask, which limits the board to
+     * (rows + 1) * columns <= 64 cells (the standard 7x6 board uses 49 bits).
+     */
+public:
+    using Bitboard = std::uint64_t;
+
+    BasicBoard() = default;
+    BasicBoard(int rows, int columns) : Size{ rows, columns } {} // RuntimeSize only, see GameState::newGame for the limit
 
     const play::game::Player& at(int row, int col) const;
     void dropStone(int column, const play::game::Player& player);
-    bool canPlay(int column) const;
-    bool isFull() const;
+    void removeStone(int column);
+    bool canPlay(int column) const { return isValidCol(column) && !isColumnFull(column); }
+    bool isFull() const { return (occupied() & topRow()) == topRow(); }
 
-    int rows() const { return m_rows; }
-    int columns() const { return m_columns; }
+    constexpr int rows() const { return Size::rows(); }
+    constexpr int columns() const { return Size::columns(); }
 
     bool checkWin(int column) const;
+    int height(int column) const;
+    constexpr int bitIndex(int row, int col) const { return col * columnHeight() + row; }
+
+    Bitboard stones(const play::game::Player& player) const;
+    Bitboard occupied() const { return m_stones[0] | m_stones[1]; }
+    bool operator==(const BasicBoard& other) const { return rows() == other.rows() && columns() == other.columns() && m_stones == other.m_stones; }
+    // all cells of the board, without the sentinel bits
+    constexpr Bitboard cells() const { return (Size::bottomRow() << rows()) - Size::bottomRow(); }
+    constexpr Bitboard columnCells(int col) const { return columnMask(col); }
+    // the shifts that move a cell one step up, right, up-right and down-right
+    constexpr std::array<int, 4> directionShifts() const { return { 1, columnHeight(), columnHeight() + 1, columnHeight() - 1 }; }
+    // bits << n and bits >> n for the walks along the directions, 0 once n leaves the 64 bits:
+    // on tall boards with few columns, two or three steps across columns can reach that far
+    static constexpr Bitboard shiftUp(Bitboard bits, int n) { return n < 64 ? bits << n : 0; }
+    static constexpr Bitboard shiftDown(Bitboard bits, int n) { return n < 64 ? bits >> n : 0; }
+
+    static int countCells(Bitboard cells) {
+        // sum the bits in parallel in fields of 2, 4 and 8 bits, then add up the bytes
+        cells = cells - ((cells >> 1) & 0x5555555555555555ull);
+        cells = (cells & 0x3333333333333333ull) + ((cells >> 2) & 0x3333333333333333ull);
+        cells = (cells + (cells >> 4)) & 0x0f0f0f0f0f0f0f0full;
+        return static_cast<int>((cells * 0x0101010101010101ull) >> 56);
+    }
+
+    // Change of GameState::streaks(player, 2) and (player, 3) if the player gets a stone at the empty cell with the bit index.
+    std::array<int, 2> streakGain(const play::game::Player& player, int bitIndex) const;
 
 private:
-    std::vector<play::game::Player> m_stones;
-    std::vector<int> m_columnHeights;
-    int m_rows, m_columns;
+    std::array<Bitboard, 2> m_stones{ 0, 0 };
 
-    bool isValidCol(int column) const { return column >= 0 && column < m_columns; }
-    bool isValidRow(int row) const { return row >= 0 && row < m_rows; }
-    bool isColumnFull(int column) const { return m_columnHeights[column] == m_rows; }
+    bool isValidCol(int column) const { return column >= 0 && column < columns(); }
+    bool isValidRow(int row) const { return row >= 0 && row < rows(); }
+    bool isColumnFull(int column) const { return (occupied() & topMask(column)) != 0; }
 
-    int linearIndex(int row, int col) const;
-    int countRun(int row, int col, const play::game::Player& player, int dRow, int dCol) const;
+    constexpr int columnHeight() const { return rows() + 1; }
+    constexpr Bitboard topRow() const { return Size::bottomRow() << (rows() - 1); }
+    constexpr Bitboard cellMask(int row, int col) const { return Bitboard{ 1 } << bitIndex(row, col); }
+    constexpr Bitboard bottomMask(int col) const { return Bitboard{ 1 } << (col * columnHeight()); }
+    constexpr Bitboard topMask(int col) const { return Bitboard{ 1 } << (col * columnHeight() + rows() - 1); }
+    constexpr Bitboard columnMask(int col) const { return ((Bitboard{ 1 } << rows()) - 1) << (col * columnHeight()); }
+    Bitboard topStone(int column) const;
 
-    friend class ConnectFourEvaluator_Streaks;
+    bool isWinningStone(Bitboard stones, Bitboard stone) const;
 };
 
-std::ostream& operator<<(std::ostream& ostr, const Board& board);
+template<class Size>
+std::ostream& operator<<(std::ostream& ostr, const BasicBoard<Size>& board);
 
-class GameState {
+template<class Size>
+class BasicGameState {
 public:
-    static GameState newGame(int rows = 6, int columns = 7);
+    using Board = BasicBoard<Size>;
+    using MoveList = play::game::MoveList<Move, Size::maxColumns>;
+
+    static BasicGameState newGame() { return BasicGameState{ Board{} }; }
+    /* RuntimeSize only. The board has to fit into the bitboard, (rows + 1) * columns <= 64
+     * (e.g. 6x7, 7x7 or 8x7, but not 8x8); other sizes throw std::invalid_argument.
+     */
+    static BasicGameState newGame(int rows, int columns) { return BasicGameState{ Board{ rows, columns } }; }
 
-    GameState dropStone(int column) const;
+    BasicGameState dropStone(int column) const;
+    void placeStone(int column); // drops a stone of the active player in place
+    void takeBackStone(int column); // undoes placeStone(column) on a state that was not over
     const play::game::Player& activePlayer() const { return m_activePlayer; }
-    bool isOver() const;
-    std::vector<int> availableMoves() const;
+    bool isOver() const { return m_isWinningState || m_board.isFull(); }
+    MoveList availableMoves() const;
     const Board& board() const { return m_board; }
     const play::game::Player& winner() const;
+    std::uint64_t hash() const { return m_hash; }
+    // same size, same stones and same player to move; unlike equal hashes, this rules out collisions
+    bool operator==(const BasicGameState& other) const { return m_board == other.m_board && m_activePlayer == other.m_activePlayer; }
+
+    /* Number of pairs of a stone of the player and a direction (up, right, up-right,
+     * down-right) such that the stone starts a run of at least length stones of the player
+     * in that direction, for length 2 and 3. The counts are updated with every stone.
+     */
+    int streaks(const play::game::Player& player, int length) const { return m_streaks[player.id() - 1][length - 2]; }
 private:
-    GameState(int rows, int columns);
-    GameState(const Board& board, const play::game::Player& nextPlayer, bool isWinninState);
-    GameState(Board&& board, const play::game::Player& nextPlayer, bool isWinningState);
+    explicit BasicGameState(const Board& board) : m_board{ board } {}
 
     Board m_board{};
     play::game::Player m_activePlayer{ play::game::Player::Player1 };
     bool m_isWinningState{ false };
+    std::uint64_t m_hash{ 0 }; // Zobrist key, updated with every dropped stone
+    std::array<std::array<int, 2>, 2> m_streaks{}; // per player, for runs of 2 and 3
 };
 
-using Move = int;
+// The board and state of the sandbox, the agents and the evaluators, sized when a game starts.
+using Board = BasicBoard<RuntimeSize>;
+using GameState = BasicGameState<RuntimeSize>;
+
+template<int Rows, int Columns>
+using FixedBoard = BasicBoard<FixedSize<Rows, Columns>>;
+template<int Rows, int Columns>
+using FixedGameState = BasicGameState<FixedSize<Rows, Columns>>;
 
 // ---- Interface to game library
 
-std::vector<int> listLegalMoves(const GameState& game);
-int askForMove(const GameState& state);
-bool isLegalMove(int col, const GameState& game);
-std::ostream& operator<<(std::ostream& ostr, const GameState& game);
-GameState applyMove(int col, const GameState& game);
+template<class Size>
+typename BasicGameState<Size>::MoveList listLegalMoves(const BasicGameState<Size>& game) {
+    return game.availableMoves();
+}
+
+template<class Size>
+int askForMove(const BasicGameState<Size>& state) {
+    std::cout << "Enter column: ";
+    int col;
+    std::cin >> col;
+    return col;
+}
+
+template<class Size>
+bool isLegalMove(int col, const BasicGameState<Size>& game) {
+    return game.board().canPlay(col);
+}
+
+template<class Size>
+std::ostream& operator<<(std::ostream& ostr, const BasicGameState<Size>& game) {
+    ostr << game.board();
+    return ostr;
+}
+
+template<class Size>
+BasicGameState<Size> applyMove(int col, const BasicGameState<Size>& game) {
+    return game.dropStone(col);
+}
+
+template<class Size>
+const play::game::Player& getActivePlayer(const BasicGameState<Size>& game) {
+    return game.activePlayer();
+}
+
+template<class Size>
+const play::game::Player& getWinner(const BasicGameState<Size>& game) {
+    return game.winner();
+}
+
+template<class Size>
+bool isGameOver(const BasicGameState<Size>& game) {
+    return game.isOver();
+}
+
+template<class Size>
+std::uint64_t hashOf(const BasicGameState<Size>& game) {
+    return game.hash();
+}
+
+template<class Size>
+int moveIndex(int col, const BasicGameState<Size>& game) {
+    return col;
+}
+
+template<class Size>
+int movePriority(int col, const BasicGameState<Size>& game) {
+    // center columns take part in the most lines of four
+    const int columns = game.board().columns();
+    return -std::abs(2 * col - (columns - 1));
+}
+
+template<class Size>
+void playRandomMove(BasicGameState<Size>& game, std::uint32_t randomBits) {
+    const auto& board = game.board();
+    int numPlayable{ 0 };
+    for (int col = 0; col < board.columns(); ++col)
+        numPlayable += board.canPlay(col) ? 1 : 0;
+    // scale the random bits to [0, numPlayable) with a multiplication instead of a division
+    auto choice = static_cast<int>((std::uint64_t{ randomBits } * numPlayable) >> 32);
+    for (int col = 0; col < board.columns(); ++col) {
+        if (board.canPlay(col) && choice-- == 0) {
+            game.placeStone(col);
+            return;
+        }
+    }
+}
+
+template<class Size>
+void makeMove(BasicGameState<Size>& game, int col) {
+    game.placeStone(col);
+}
 
-const play::game::Player& getActivePlayer(const GameState& game);
-const play::game::Player& getWinner(const GameState& game);
-bool isGameOver(const GameState& game);
+template<class Size>
+void unmakeMove(BasicGameState<Size>& game, int col) {
+    game.takeBackStone(col);
+}
 
 class ConnectFourEvaluator_Streaks : public play::game::GameStateEvaluator<int, GameState> {
     /* Evaluate game state based on runs of stones of the same player.
      * Adapted from an implementation by prakhar10 [https://github.com/prakhar10/Connect4]
+     * The runs are counted incrementally by the GameState (see GameState::streaks), so an
+     * evaluation costs O(1).
      */
 public:
     int evaluateGameState(const GameState& gameState) override;
-    
+
     int lowerBound() const override { return loosingValue; }
     int upperBound() const override { return winningValue; }
 private:
     static constexpr int winningValue = 10000;
     static constexpr int loosingValue = -10000;
+};
+
+class ConnectFourEvaluator_Threats : public play::game::GameStateEvaluator<int, GameState> {
+    /* Evaluate game state based on open lines: windows of four cells in a line that contain
+     * stones of only one player. Windows with three and two stones are counted for both
+     * players with bit operations on all windows of a direction at once, plus a small bonus
+     * for stones in the center column, where most lines cross.
+     */
+public:
+    int evaluateGameState(const GameState& gameState) override;
 
-    int checkForStreak(const GameState& game, const play::game::Player& player, int length);
-    int checkVerticalStreak(int row, int col, const Board& board, int length);
-    int checkHorizontalStreak(int row, int col, const Board& board, int length);
-    int checkDiagonalStreak(int row, int col, const Board& board, int length);
+    int lowerBound() const override { return loosingValue; }
+    int upperBound() const override { return winningValue; }
+private:
+    static constexpr int winningValue = 10000;
+    static constexpr int loosingValue = -10000;
+    static constexpr int threeWeight = 5;
+    static constexpr int twoWeight = 2;
+    static constexpr int centerWeight = 3;
+
+    int score(const Board& board, const play::game::Player& player) const;
 };
 
+// ---- Implementation of the board and the game state
+
+template<class Size>
+const play::game::Player& BasicBoard<Size>::at(int row, int col) const {
+    if (isValidRow(row) && isValidCol(col)) {
+        const auto cell = cellMask(row, col);
+        if (m_stones[0] & cell)
+            return play::game::Player::Player1;
+        else if (m_stones[1] & cell)
+            return play::game::Player::Player2;
+    }
+    return play::game::Player::None;
 }
 
-#endif
+template<class Size>
+void BasicBoard<Size>::dropStone(int column, const play::game::Player& player) {
+    if (canPlay(column) && player != play::game::Player::None) {
+        // adding the bottom bit to the occupied cells of a column carries into the lowest free cell
+        const auto landingCell = (occupied() & columnMask(column)) + bottomMask(column);
+        m_stones[player.id() - 1] |= landingCell;
+    }
+}
+
+template<class Size>
+void BasicBoard<Size>::removeStone(int column) {
+    if (isValidCol(column)) {
+        const auto stone = topStone(column);
+        m_stones[0] &= ~stone;
+        m_stones[1] &= ~stone;
+    }
+}
+
+template<class Size>
+typename BasicBoard<Size>::Bitboard BasicBoard<Size>::stones(const play::game::Player& player) const {
+    if (player == play::game::Player::None)
+        return 0;
+    return m_stones[player.id() - 1];
+}
+
+template<class Size>
+typename BasicBoard<Size>::Bitboard BasicBoard<Size>::topStone(int column) const {
+    const auto nextFree = (occupied() & columnMask(column)) + bottomMask(column);
+    if (nextFree == bottomMask(column))
+        return 0;
+    return nextFree >> 1;
+}
+
+template<class Size>
+bool BasicBoard<Size>::checkWin(int column) const {
+    if (!isValidCol(column))
+        return false;
+    const auto stone = topStone(column);
+    if (m_stones[0] & stone)
+        return isWinningStone(m_stones[0], stone);
+    else if (m_stones[1] & stone)
+        return isWinningStone(m_stones[1], stone);
+    return false;
+}
+
+template<class Size>
+int BasicBoard<Size>::height(int column) const {
+    if (!isValidCol(column))
+        return 0;
+    auto columnStones = (occupied() & columnMask(column)) >> bitIndex(0, column);
+    int height = 0;
+    while (columnStones & 1) {
+        ++height;
+        columnStones >>= 1;
+    }
+    return height;
+}
+
+template<class Size>
+bool BasicBoard<Size>::isWinningStone(Bitboard stones, Bitboard stone) const {
+    // the sentinel bits stop runs from wrapping
+    for (const auto shift : directionShifts()) {
+        const auto pairs = stones & shiftDown(stones, shift);
+        const auto fours = pairs & shiftDown(pairs, 2 * shift);
+        if (fours == 0)
+            continue;
+        const auto covered = fours | shiftUp(fours, shift) | shiftUp(fours, 2 * shift) | shiftUp(fours, 3 * shift);
+        if (covered & stone)
+            return true;
+    }
+    return false;
+}
+
+template<class Size>
+std::array<int, 2> BasicBoard<Size>::streakGain(const play::game::Player& player, int bitIndex) const {
+    const auto playerStones = stones(player);
+    const auto cell = Bitboard{ 1 } << bitIndex;
+    std::array<int, 2> gain{ 0, 0 };
+    // the sentinel bits stop runs from wrapping
+    for (const auto shift : directionShifts()) {
+        // only the nearest two stones on each side can change a count for runs up to three
+        const int before = !(shiftDown(cell, shift) & playerStones) ? 0 : ((shiftDown(cell, 2 * shift) & playerStones) ? 2 : 1);
+        const int after = !(shiftUp(cell, shift) & playerStones) ? 0 : ((shiftUp(cell, 2 * shift) & playerStones) ? 2 : 1);
+        // the new stone starts runs of 1 + after stones, the stones before it get longer runs
+        gain[0] += (after >= 1) + (before >= 1);
+        gain[1] += (after >= 2) + (before >= 1 && after >= 1) + (before >= 2);
+    }
+    return gain;
+}
+
+namespace detail {
+// one key per player and bit of the bitboard, plus one key that toggles with the active player
+inline constexpr auto zobristKeys = play::game::makeZobristKeys<2 * 64 + 1>(0xc0ecf0a7);
+inline constexpr auto activePlayerKey = zobristKeys[2 * 64];
+
+inline std::uint64_t stoneKey(const play::game::Player& player, int bitIndex) {
+    return zobristKeys[(player.id() - 1) * 64 + bitIndex];
+}
+
+inline char boardMarker(const play::game::Player& player) {
+    if (player == play::game::Player::Player1)
+        return 'X';
+    else if (player == play::game::Player::Player2)
+        return 'O';
+    else
+        return ' ';
+}
+}
 
+template<class Size>
+std::ostream& operator<<(std::ostream& ostr, const BasicBoard<Size>& board) {
+    for (int col = 0; col < board.columns(); ++col)
+        ostr << "  " << col << ' ';
+    ostr << '\n';
+    for (int row = 0; row < board.rows(); ++row) {
+        for (int col = 0; col < board.columns(); ++col)
+            ostr << "+---";
+        ostr << "+\n";
+        for (int col = 0; col < board.columns(); ++col) {
+            ostr << "| " << detail::boardMarker(board.at(board.rows() - row - 1, col)) << ' ';
+        }
+        ostr << "|\n";
+    }
+    for (int col = 0; col < board.columns(); ++col)
+        ostr << "+---";
+    ostr << "+\n";
+    return ostr;
+}
+
+template<class Size>
+BasicGameState<Size> BasicGameState<Size>::dropStone(int column) const {
+    BasicGameState next{ *this };
+    next.placeStone(column);
+    return next;
+}
+
+template<class Size>
+void BasicGameState<Size>::placeStone(int column) {
+    if (m_board.canPlay(column)) {
+        const int bitIndex = m_board.bitIndex(m_board.height(column), column);
+        m_hash ^= detail::stoneKey(m_activePlayer, bitIndex) ^ detail::activePlayerKey;
+        const auto gain = m_board.streakGain(m_activePlayer, bitIndex);
+        auto& streaks = m_streaks[m_activePlayer.id() - 1];
+        streaks[0] += gain[0];
+        streaks[1] += gain[1];
+        m_board.dropStone(column, m_activePlayer);
+        m_isWinningState = m_board.checkWin(column);
+        m_activePlayer = m_activePlayer.other();
+    }
+}
+
+template<class Size>
+void BasicGameState<Size>::takeBackStone(int column) {
+    if (m_board.height(column) > 0) {
+        m_activePlayer = m_activePlayer.other();
+        m_board.removeStone(column);
+        const int bitIndex = m_board.bitIndex(m_board.height(column), column);
+        m_hash ^= detail::stoneKey(m_activePlayer, bitIndex) ^ detail::activePlayerKey;
+        const auto gain = m_board.streakGain(m_activePlayer, bitIndex);
+        auto& streaks = m_streaks[m_activePlayer.id() - 1];
+        streaks[0] -= gain[0];
+        streaks[1] -= gain[1];
+        m_isWinningState = false;
+    }
+}
+
+template<class Size>
+typename BasicGameState<Size>::MoveList BasicGameState<Size>::availableMoves() const {
+    MoveList legalMoves;
+    for (int col = 0; col < m_board.columns(); ++col)
+        if (m_board.canPlay(col))
+            legalMoves.push_back(col);
+    return legalMoves;
+}
+
+template<class Size>
+const play::game::Player& BasicGameState<Size>::winner() const {
+    if (m_isWinningState)
+        return m_activePlayer.other();
+    else
+        return play::game::Player::None;
+}
+
+// the runtime-sized variant is compiled once, in the library
+extern template class BasicBoard<RuntimeSize>;
+extern template class BasicGameState<RuntimeSize>;
+
+}
+
+#endif
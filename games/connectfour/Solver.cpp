@@ -0,0 +1,216 @@
+/* *********************************************************** *
+ * ConnectFour
+ * Solver.cpp
+ * *********************************************************** */
+
+#include "Solver.h"
+#include "twoplayergames/Random.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace play::connectfour {
+
+namespace {
+using play::agent::Bound;
+
+// the sum of the stones of the active player and all stones identifies a position, the
+// mixing spreads it over the buckets of the table and keeps it unique
+std::uint64_t keyOf(std::uint64_t current, std::uint64_t mask) {
+    auto state = current + mask;
+    return play::splitmix64(state);
+}
+}
+
+Solver::Solver(std::size_t transpositionTableMB) :
+    table{ transpositionTableMB } {
+}
+
+std::vector<Move> Solver::selectMoves(const GameState& game) {
+    return analyse(game).second;
+}
+
+std::pair<int, std::vector<Move>> Solver::analyse(const GameState& game) {
+    if (game.isOver())
+        return { solve(game), {} };
+    nodes = 0;
+    table.newSearch();
+    const auto position = setUp(game);
+    const int value = solve(position);
+
+    std::vector<Move> bestMoves;
+    const auto winningMoves = winningCells(position.current, position.mask);
+    for (int col = 0; col < columns; ++col) {
+        const auto move = playableCells(position) & columnCells[col];
+        if (move == 0)
+            continue;
+        bool keepsValue;
+        if (move & winningMoves)
+            keepsValue = winNowValue(position) == value;
+        else if (const auto child = afterMove(position, move); canWinNext(child))
+            keepsValue = -winNowValue(child) == value;
+        else // the null window only tells whether the move reaches the value
+            keepsValue = negamax(child, -value, -value + 1) <= -value;
+        if (keepsValue)
+            bestMoves.push_back(col);
+    }
+    return { value, std::move(bestMoves) };
+}
+
+int Solver::solve(const GameState& game) {
+    nodes = 0;
+    if (game.isOver()) {
+        const int stones = Board::countCells(game.board().occupied());
+        return game.winner() == play::game::Player::None ? 0 : -(game.board().rows() * game.board().columns() + 2 - stones) / 2;
+    }
+    table.newSearch();
+    return solve(setUp(game));
+}
+
+Solver::Position Solver::setUp(const GameState& game) {
+    const auto& board = game.board();
+    if (board.rows() != rows || board.columns() != columns) {
+        // the keys of the table are only unique for one board size
+        table.clear();
+        rows = board.rows();
+        columns = board.columns();
+        cells = rows * columns;
+        boardCells = board.cells();
+        bottomRow = 0;
+        for (int col = 0; col < columns; ++col) {
+            columnCells[col] = board.columnCells(col);
+            bottomRow |= Bitboard{ 1 } << board.bitIndex(0, col);
+        }
+        std::iota(columnOrder.begin(), columnOrder.begin() + columns, 0);
+        std::stable_sort(columnOrder.begin(), columnOrder.begin() + columns,
+            [&game](int col1, int col2) { return movePriority(col1, game) > movePriority(col2, game); });
+    }
+    const auto mask = board.occupied();
+    return Position{ board.stones(game.activePlayer()), mask, Board::countCells(mask) };
+}
+
+int Solver::solve(const Position& position) {
+    if (canWinNext(position))
+        return winNowValue(position);
+    // bisect the range of possible values with null-window searches, which prune the most;
+    // the first tests are close to 0, where most values lie
+    int minValue = lossNextValue(position);
+    int maxValue = (cells - 1 - position.moves) / 2;
+    while (minValue < maxValue) {
+        int test = minValue + (maxValue - minValue) / 2;
+        if (test <= 0 && minValue / 2 < test)
+            test = minValue / 2;
+        else if (test >= 0 && maxValue / 2 > test)
+            test = maxValue / 2;
+        const int value = negamax(position, test, test + 1);
+        if (value <= test)
+            maxValue = value;
+        else
+            minValue = value;
+    }
+    return minValue;
+}
+
+int Solver::negamax(const Position& position, int alpha, int beta) {
+    // the active player can not win with the next stone, the callers check this first
+    ++nodes;
+    const auto moves = nonLosingMoves(position);
+    if (moves == 0)
+        return lossNextValue(position);
+    if (position.moves >= cells - 2)
+        return 0;
+
+    // the opponent can not win with the next stone any more, nor can the active player
+    alpha = std::max(alpha, -(cells - 2 - position.moves) / 2);
+    if (alpha >= beta)
+        return alpha;
+    beta = std::min(beta, (cells - 1 - position.moves) / 2);
+    if (alpha >= beta)
+        return beta;
+
+    const auto key = keyOf(position.current, position.mask);
+    const int depth = cells - position.moves;
+    auto bestColumn = play::agent::TranspositionEntry<int>::noMove;
+    if (play::agent::TranspositionEntry<int> entry; table.probe(key, entry)) {
+        if (entry.bound == Bound::Exact)
+            return entry.value;
+        if (entry.bound == Bound::Lower)
+            alpha = std::max(alpha, entry.value);
+        else
+            beta = std::min(beta, entry.value);
+        if (alpha >= beta)
+            return entry.value;
+        bestColumn = entry.bestMove;
+    }
+
+    struct Candidate {
+        Bitboard move;
+        int column;
+        int threats;
+    };
+    std::array<Candidate, maxLegalMoves> candidates;
+    int numCandidates{ 0 };
+    for (int i = 0; i < columns; ++i) {
+        const int col = columnOrder[i];
+        if (const auto move = moves & columnCells[col]) {
+            // the best move of an earlier search first, then the moves that leave the most
+            // cells where the active player would complete a line; ties keep the center order
+            const int threats = col == bestColumn ? cells : Board::countCells(winningCells(position.current | move, position.mask | move));
+            int j = numCandidates++;
+            for (; j > 0 && candidates[j - 1].threats < threats; --j)
+                candidates[j] = candidates[j - 1];
+            candidates[j] = Candidate{ move, col, threats };
+        }
+    }
+
+    for (int i = 0; i < numCandidates; ++i) {
+        const auto& candidate = candidates[i];
+        const int value = -negamax(afterMove(position, candidate.move), -beta, -alpha);
+        if (value >= beta) {
+            table.store(key, value, depth, Bound::Lower, static_cast<std::uint8_t>(candidate.column));
+            return value;
+        }
+        if (value > alpha) {
+            alpha = value;
+            bestColumn = static_cast<std::uint8_t>(candidate.column);
+        }
+    }
+    table.store(key, alpha, depth, Bound::Upper, bestColumn);
+    return alpha;
+}
+
+Solver::Bitboard Solver::winningCells(Bitboard stones, Bitboard mask) const {
+    // three stones below
+    auto wins = (stones << 1) & (stones << 2) & (stones << 3);
+    // the lines across columns need at least four columns; with them, three steps in any
+    // direction stay within the 64 bits. The sentinel bits stop runs from wrapping.
+    if (columns >= 4) {
+        const int columnHeight = rows + 1;
+        for (const int shift : { columnHeight, columnHeight + 1, columnHeight - 1 }) {
+            // the empty cell at either end of three stones, or between one and two stones
+            auto pairs = (stones << shift) & (stones << (2 * shift));
+            wins |= pairs & (stones << (3 * shift));
+            wins |= pairs & (stones >> shift);
+            pairs = (stones >> shift) & (stones >> (2 * shift));
+            wins |= pairs & (stones << shift);
+            wins |= pairs & (stones >> (3 * shift));
+        }
+    }
+    return wins & boardCells & ~mask;
+}
+
+Solver::Bitboard Solver::nonLosingMoves(const Position& position) const {
+    auto moves = playableCells(position);
+    const auto opponentWins = winningCells(position.current ^ position.mask, position.mask);
+    if (const auto forced = moves & opponentWins) {
+        // two threats can not both be blocked
+        if (forced & (forced - 1))
+            return 0;
+        moves = forced;
+    }
+    // a stone below a cell where the opponent would complete a line makes it playable
+    return moves & ~(opponentWins >> 1);
+}
+
+}
@@ -0,0 +1,84 @@
+/* *********************************************************** *
+ * ConnectFour
+ * Solver.h
+ * *********************************************************** */
+
+#ifndef CONNECT_FOUR_SOLVER_H
+#define CONNECT_FOUR_SOLVER_H
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "ConnectFour.h"
+#include "twoplayergames/agent/Agent.h"
+#include "twoplayergames/agent/TranspositionTable.h"
+
+namespace play::connectfour {
+
+class Solver : public play::agent::Agent<GameState, Move> {
+    /* Perfect play: searches every position to the end of the game and selects all moves
+     * that keep its game-theoretic value.
+     * The value of a state is positive if the active player can force a win, negative if the
+     * opponent can, and 0 for a draw. Its size rewards quick wins and slow losses: it is 1 plus
+     * the number of stones the winner still has left after the winning stone. The empty
+     * standard board has value 1, the first player wins with the last stone.
+     *
+     * The search is a negamax with alpha-beta pruning on its own pair of bitboards, driven by
+     * null-window searches that bisect the range of possible values (as in MTD(f)). It never
+     * searches moves that let the opponent win at once or ignore an immediate threat, tries
+     * the moves that create the most threats first (ties go to the center), and keeps the
+     * bounds it proved in a transposition table, which stays filled between moves.
+     * Works on every board size Board supports. On the standard 7x6 board, positions with
+     * about eight stones or more are solved within seconds; the first few moves take minutes.
+     */
+public:
+    explicit Solver(std::size_t transpositionTableMB = 64);
+
+    std::vector<Move> selectMoves(const GameState& game) override;
+
+    // game-theoretic value of a state that is not over, for its active player
+    int solve(const GameState& game);
+
+    // the value of solve and the moves of selectMoves from one search
+    std::pair<int, std::vector<Move>> analyse(const GameState& game);
+
+    // number of nodes visited since the last call of selectMoves, solve or analyse
+    unsigned long long nodesSearched() const { return nodes; }
+
+private:
+    using Bitboard = Board::Bitboard;
+
+    struct Position {
+        Bitboard current; // stones of the active player
+        Bitboard mask;    // all stones
+        int moves;        // number of stones
+    };
+
+    play::agent::TranspositionTable<int> table;
+    unsigned long long nodes{ 0 };
+
+    // geometry of the board of the last search
+    int rows{ 0 }, columns{ 0 }, cells{ 0 };
+    Bitboard bottomRow{ 0 }, boardCells{ 0 };
+    std::array<Bitboard, maxLegalMoves> columnCells{};
+    std::array<int, maxLegalMoves> columnOrder{}; // center first
+
+    Position setUp(const GameState& game);
+    int solve(const Position& position);
+    int negamax(const Position& position, int alpha, int beta);
+
+    // empty cells where the stones would complete a line
+    Bitboard winningCells(Bitboard stones, Bitboard mask) const;
+    Bitboard playableCells(const Position& position) const { return (position.mask + bottomRow) & boardCells; }
+    Bitboard nonLosingMoves(const Position& position) const;
+    bool canWinNext(const Position& position) const { return (winningCells(position.current, position.mask) & playableCells(position)) != 0; }
+    static Position afterMove(const Position& position, Bitboard move) { return { position.current ^ position.mask, position.mask | move, position.moves + 1 }; }
+    // values of a win with the next stone of the active player and of the opponent
+    int winNowValue(const Position& position) const { return (cells + 1 - position.moves) / 2; }
+    int lossNextValue(const Position& position) const { return -(cells - position.moves) / 2; }
+};
+
+}
+
+#endif
@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+#include "connectfour/ConnectFour.h"
+#include "twoplayergames/agent/MCTSPlayer.h"
+#include "twoplayergames/agent/MinimaxPlayer.h"
+#include "twoplayergames/gameplay/InvisibleMatch.h"
+#include "twoplayergames/gameplay/Tournament.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+play::connectfour::GameState playMoves(const std::vector<int>& moves) {
+    auto game = play::connectfour::GameState::newGame();
+    for (const auto m : moves)
+        game = game.dropStone(m);
+    return game;
+}
+
+bool sameMoves(std::vector<int> m1, std::vector<int> m2) {
+    std::sort(m1.begin(), m1.end());
+    std::sort(m2.begin(), m2.end());
+    return m1 == m2;
+}
+
+const std::vector<std::vector<int>> testPositions{
+    {},
+    { 3, 3, 2 },
+    { 3, 2, 3, 3, 4, 1 },
+    { 1, 2, 0, 1, 2, 4, 3, 2, 1, 5, 6, 3 },
+};
+
+}
+
+TEST(MinimaxPlayer, TranspositionTableKeepsResult) {
+    using namespace play::connectfour;
+    using Player = play::agent::MinimaxPlayer<GameState, Move, ConnectFourEvaluator_Streaks>;
+
+    for (const auto& moves : testPositions) {
+        const auto game = playMoves(moves);
+        Player plain{ 4, 0 };
+        Player cached{ 4, 1 };
+        EXPECT_TRUE(sameMoves(plain.selectMoves(game), cached.selectMoves(game)));
+    }
+}
+
+TEST(MinimaxPlayer, IterativeDeepeningRespectsBudget) {
+    using namespace play::connectfour;
+    using Player = play::agent::MinimaxPlayer<GameState, Move, ConnectFourEvaluator_Streaks>;
+
+    const auto game = playMoves({ 3, 3 });
+    Player timed{ std::chrono::milliseconds{ 100 } };
+    const auto start = std::chrono::steady_clock::now();
+    const auto moves = timed.selectMoves(game);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_FALSE(moves.empty());
+    for (const auto m : moves)
+        EXPECT_TRUE(isLegalMove(m, game));
+    // the search has no depth limit and can not solve the position in this time, so only
+    // the clock can have stopped it; the margin leaves room for a loaded machine
+    EXPECT_LT(elapsed, std::chrono::seconds{ 10 });
+}
+
+TEST(MinimaxPlayer, IterativeDeepeningMatchesFixedDepth) {
+    using namespace play::connectfour;
+    using Player = play::agent::MinimaxPlayer<GameState, Move, ConnectFourEvaluator_Streaks>;
+
+    for (const auto& moves : testPositions) {
+        const auto game = playMoves(moves);
+        Player fixed{ 4 };
+        Player deepening{ std::chrono::hours{ 1 }, 4 };
+        EXPECT_TRUE(sameMoves(fixed.selectMoves(game), deepening.selectMoves(game)));
+    }
+}
+
+TEST(MinimaxPlayer, MoveOrderingReducesNodes) {
+    using namespace play::connectfour;
+    using Generated = play::agent::MinimaxPlayer<GameState, Move, ConnectFourEvaluator_Streaks, play::agent::GeneratedMoveOrdering<GameState, Move>>;
+    using Heuristic = play::agent::MinimaxPlayer<GameState, Move, ConnectFourEvaluator_Streaks>;
+
+    for (const auto& moves : testPositions) {
+        const auto game = playMoves(moves);
+        Generated generated{ 6 };
+        Heuristic heuristic{ 6 };
+        EXPECT_TRUE(sameMoves(generated.selectMoves(game), heuristic.selectMoves(game)));
+        EXPECT_LT(heuristic.nodesSearched(), generated.nodesSearched());
+    }
+}
+
+TEST(MinimaxPlayer, RootParallelSearchMatchesSequential) {
+    using namespace play::connectfour;
+    using Player = play::agent::MinimaxPlayer<GameState, Move, ConnectFourEvaluator_Streaks>;
+
+    for (const auto& moves : testPositions) {
+        const auto game = playMoves(moves);
+        Player sequential{ 5 };
+        Player parallel{ 5, 16, 4 };
+        EXPECT_TRUE(sameMoves(sequential.selectMoves(game), parallel.selectMoves(game)));
+    }
+
+    Player timed{ std::chrono::milliseconds{ 100 }, -1, 16, 4 };
+    const auto moves = timed.selectMoves(playMoves({ 3 }));
+    EXPECT_FALSE(moves.empty());
+}
+
+TEST(MinimaxPlayer, LazySMPRespectsBudget) {
+    using namespace play::connectfour;
+    using Player = play::agent::MinimaxPlayer<GameState, Move, ConnectFourEvaluator_Streaks>;
+
+    const auto game = playMoves({ 3, 2 });
+    Player lazySMP{ std::chrono::milliseconds{ 100 }, -1, 16, 4, play::agent::ParallelSearch::LazySMP };
+    const auto start = std::chrono::steady_clock::now();
+    const auto moves = lazySMP.selectMoves(game);
+    // as above, only the clock can stop the search; the margin leaves room for a loaded machine
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds{ 10 });
+    EXPECT_FALSE(moves.empty());
+    for (const auto m : moves)
+        EXPECT_TRUE(isLegalMove(m, game));
+}
+
+TEST(MCTSPlayer, RootParallelFindsWin) {
+    using namespace play::connectfour;
+
+    // the active player completes the bottom row in column 3
+    const auto game = playMoves({ 0, 0, 1, 1, 2, 2 });
+    play::agent::MCTSPlayer<GameState, Move, 2000> mcts{ 4 };
+    EXPECT_EQ(mcts.selectMoves(game), std::vector<int>{ 3 });
+}
+
+TEST(MCTSPlayer, TreeParallelFindsWin) {
+    using namespace play::connectfour;
+
+    const auto game = playMoves({ 0, 0, 1, 1, 2, 2 });
+    play::agent::MCTSPlayer<GameState, Move, 2000> mcts{ 4, play::agent::ParallelMCTS::TreeParallel };
+    EXPECT_EQ(mcts.selectMoves(game), std::vector<int>{ 3 });
+}
+
+TEST(MCTSPlayer, ReusesTreeOfLastMove) {
+    using namespace play::connectfour;
+
+    for (const auto mode : { play::agent::ParallelMCTS::RootParallel, play::agent::ParallelMCTS::TreeParallel }) {
+        play::agent::MCTSPlayer<GameState, Move, 2000> mcts{ 2, mode };
+        const auto first = mcts.selectMoves(playMoves({ 3 }));
+        EXPECT_EQ(mcts.reusedRollouts(), 0);
+
+        // our move and the reply of the opponent are two plies below the last root
+        mcts.selectMoves(playMoves({ 3, first.front(), 3 }));
+        EXPECT_GT(mcts.reusedRollouts(), 0);
+
+        // a new game starts with a fresh tree
+        mcts.selectMoves(playMoves({}));
+        EXPECT_EQ(mcts.reusedRollouts(), 0);
+    }
+}
+
+TEST(MCTSPlayer, SeededMatchesAreReproducible) {
+    using namespace play::connectfour;
+
+    const auto playMatches = [] {
+        std::vector<int> winners;
+        for (std::uint64_t seed = 1; seed <= 8; ++seed) {
+            play::seedThreadRandom(seed);
+            play::agent::MCTSPlayer<GameState, Move, 100> player1;
+            play::agent::MCTSPlayer<GameState, Move, 100> player2;
+            winners.push_back(play::game::playInvisibleMatch<GameState, Move>(&player1, &player2).id());
+        }
+        return winners;
+    };
+    EXPECT_EQ(playMatches(), playMatches());
+}
+
+namespace {
+// the score of the threat evaluator, counted window by window
+int threatScore(const play::connectfour::Board& board, const play::game::Player& player) {
+    const std::array<std::array<int, 2>, 4> directions{ { { 1, 0 }, { 0, 1 }, { 1, 1 }, { -1, 1 } } };
+    int score{ 0 };
+    for (int row = 0; row < board.rows(); ++row) {
+        for (int col = 0; col < board.columns(); ++col) {
+            for (const auto& [dRow, dCol] : directions) {
+                const int endRow = row + 3 * dRow, endCol = col + 3 * dCol;
+                if (endRow < 0 || endRow >= board.rows() || endCol >= board.columns())
+                    continue;
+                int own{ 0 }, other{ 0 };
+                for (int i = 0; i < 4; ++i) {
+                    const auto& stone = board.at(row + i * dRow, col + i * dCol);
+                    own += stone == player ? 1 : 0;
+                    other += stone == player.other() ? 1 : 0;
+                }
+                if (other == 0 && own == 3)
+                    score += 5;
+                else if (other == 0 && own == 2)
+                    score += 2;
+            }
+        }
+        if (board.at(row, board.columns() / 2) == player)
+            score += 3;
+    }
+    return score;
+}
+}
+
+TEST(ConnectFourEvaluator_Threats, CountsOpenWindows) {
+    using namespace play::connectfour;
+
+    ConnectFourEvaluator_Threats evaluator;
+    play::Xoshiro256 random{ 21 };
+    for (int game = 0; game < 50; ++game) {
+        auto state = GameState::newGame();
+        while (!isGameOver(state)) {
+            const auto& player = state.activePlayer();
+            EXPECT_EQ(evaluator.evaluateGameState(state), threatScore(state.board(), player) - threatScore(state.board(), player.other()));
+            playRandomMove(state, static_cast<std::uint32_t>(random() >> 32));
+        }
+    }
+}
+
+TEST(ConnectFourEvaluator_Threats, CountsOpenWindowsOnTallNarrowBoard) {
+    using namespace play::connectfour;
+
+    // three steps across columns leave the 64 bits, no window fits across the columns
+    ConnectFourEvaluator_Threats evaluator;
+    play::Xoshiro256 random{ 22 };
+    for (int game = 0; game < 20; ++game) {
+        auto state = GameState::newGame(20, 3);
+        while (!isGameOver(state)) {
+            const auto& player = state.activePlayer();
+            EXPECT_EQ(evaluator.evaluateGameState(state), threatScore(state.board(), player) - threatScore(state.board(), player.other()));
+            playRandomMove(state, static_cast<std::uint32_t>(random() >> 32));
+        }
+    }
+}
+
+TEST(ConnectFourEvaluator_Threats, BeatsStreaks) {
+    using namespace play::connectfour;
+    using namespace play::game;
+
+    const AgentFactory<GameState, Move> threats = [] { return std::make_unique<play::agent::MinimaxPlayer<GameState, Move, ConnectFourEvaluator_Threats>>(4, 1); };
+    const AgentFactory<GameState, Move> streaks = [] { return std::make_unique<play::agent::MinimaxPlayer<GameState, Move, ConnectFourEvaluator_Streaks>>(4, 1); };
+    const auto result = playTournament<GameState, Move>(threats, streaks, TournamentOptions{ 20, 1, 3 }, {});
+    EXPECT_GT(result.firstAgentWins, result.secondAgentWins);
+}
@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 #include "connectfour/ConnectFour.h"
 
+#include <random>
+#include <stdexcept>
+#include <utility>
+
 TEST(Board, Stones) {
     using namespace play::connectfour;
     using namespace play::game;
@@ -109,4 +113,142 @@ TEST(Board, Winner) {
     EXPECT_TRUE(board.checkWin(3));
     board.dropStone(6, Player::Player2);
     EXPECT_FALSE(board.checkWin(6));
-}
\ No newline at end of file
+}
+
+TEST(Board, NoWrapAround) {
+    using namespace play::connectfour;
+    using namespace play::game;
+
+    // two stones at the top of column 0 and two at the bottom of column 1
+    // are adjacent in the bit layout, but must not count as a vertical run
+    Board board;
+    for (int i = 0; i < 4; ++i)
+        board.dropStone(0, Player::Player2);
+    board.dropStone(0, Player::Player1);
+    board.dropStone(0, Player::Player1);
+    board.dropStone(1, Player::Player1);
+    board.dropStone(1, Player::Player1);
+    EXPECT_FALSE(board.checkWin(0));
+    EXPECT_FALSE(board.checkWin(1));
+
+    // a horizontal run at the right edge must not continue into the next row
+    Board edge;
+    edge.dropStone(5, Player::Player1);
+    edge.dropStone(6, Player::Player1);
+    edge.dropStone(0, Player::Player2);
+    edge.dropStone(0, Player::Player1);
+    edge.dropStone(1, Player::Player1);
+    EXPECT_FALSE(edge.checkWin(1));
+    EXPECT_FALSE(edge.checkWin(6));
+
+    // three stones at the top of column 5 and one at the bottom of the last column are
+    // only the sentinel bit apart, but no vertical run
+    Board corner;
+    corner.dropStone(5, Player::Player2);
+    corner.dropStone(5, Player::Player1);
+    corner.dropStone(5, Player::Player2);
+    for (int i = 0; i < 3; ++i)
+        corner.dropStone(5, Player::Player1);
+    corner.dropStone(6, Player::Player1);
+    EXPECT_FALSE(corner.checkWin(5));
+    EXPECT_FALSE(corner.checkWin(6));
+
+    // the down-right diagonal through (2, 3), (1, 4) and (0, 5) continues at the top of the
+    // last column in the bit layout, behind the sentinel of column 5
+    Board diagonal;
+    diagonal.dropStone(3, Player::Player2);
+    diagonal.dropStone(3, Player::Player2);
+    diagonal.dropStone(3, Player::Player1);
+    diagonal.dropStone(4, Player::Player2);
+    diagonal.dropStone(4, Player::Player1);
+    diagonal.dropStone(5, Player::Player1);
+    for (int i = 0; i < 5; ++i)
+        diagonal.dropStone(6, i % 2 == 0 ? Player::Player2 : Player::Player1);
+    diagonal.dropStone(6, Player::Player1);
+    EXPECT_FALSE(diagonal.checkWin(5));
+    EXPECT_FALSE(diagonal.checkWin(6));
+
+    // a run up to the sentinel of the last column still wins
+    Board top;
+    top.dropStone(6, Player::Player2);
+    top.dropStone(6, Player::Player2);
+    for (int i = 0; i < 3; ++i)
+        top.dropStone(6, Player::Player1);
+    EXPECT_FALSE(top.checkWin(6));
+    top.dropStone(6, Player::Player1);
+    EXPECT_TRUE(top.checkWin(6));
+}
+
+TEST(Board, DiagonalWin) {
+    using namespace play::connectfour;
+    using namespace play::game;
+
+    Board board;
+    board.dropStone(0, Player::Player1);
+    board.dropStone(1, Player::Player2);
+    board.dropStone(1, Player::Player1);
+    board.dropStone(2, Player::Player2);
+    board.dropStone(2, Player::Player2);
+    board.dropStone(2, Player::Player1);
+    board.dropStone(3, Player::Player2);
+    board.dropStone(3, Player::Player2);
+    board.dropStone(3, Player::Player2);
+    EXPECT_FALSE(board.checkWin(3));
+    board.dropStone(3, Player::Player1);
+    EXPECT_TRUE(board.checkWin(3));
+    EXPECT_EQ(board.stones(Player::Player1) & board.stones(Player::Player2), 0u);
+}
+
+TEST(Board, RejectsBoardsTooLargeForBitboard) {
+    using namespace play::connectfour;
+
+    EXPECT_THROW(Board(8, 8), std::invalid_argument);
+    EXPECT_THROW(GameState::newGame(0, 7), std::invalid_argument);
+    EXPECT_THROW(Board(6, 0), std::invalid_argument);
+    // the largest boards that fit
+    EXPECT_NO_THROW(GameState::newGame(7, 8));
+    EXPECT_NO_THROW(GameState::newGame(63, 1));
+}
+
+namespace {
+// whether the player has four stones in a row anywhere, checked cell by cell
+bool hasLineOfFour(const play::connectfour::Board& board, const play::game::Player& player) {
+    const int directions[4][2]{ { 1, 0 }, { 0, 1 }, { 1, 1 }, { -1, 1 } };
+    for (int row = 0; row < board.rows(); ++row) {
+        for (int col = 0; col < board.columns(); ++col) {
+            for (const auto& [dRow, dCol] : directions) {
+                int run{ 0 };
+                while (run < 4 && board.at(row + run * dRow, col + run * dCol) == player)
+                    ++run;
+                if (run == 4)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+}
+
+TEST(Board, TallNarrowBoards) {
+    using namespace play::connectfour;
+    using namespace play::game;
+
+    // three steps across columns leave the 64 bits, the win check must not shift that far
+    std::mt19937 random{ 1 };
+    for (const auto& [rows, columns] : { std::pair{ 20, 3 }, std::pair{ 31, 2 }, std::pair{ 63, 1 } }) {
+        for (int game = 0; game < 20; ++game) {
+            Board board{ rows, columns };
+            const Player* player = &Player::Player1;
+            bool won = false;
+            while (!won && !board.isFull()) {
+                int column = static_cast<int>(random() % static_cast<unsigned>(columns));
+                while (!board.canPlay(column))
+                    column = (column + 1) % columns;
+                board.dropStone(column, *player);
+                won = board.checkWin(column);
+                ASSERT_EQ(won, hasLineOfFour(board, *player));
+                player = &player->other();
+            }
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include "connectfour/ConnectFour.h"
+#include "connectfour/Solver.h"
+#include "twoplayergames/agent/BookPlayer.h"
+#include "twoplayergames/gameplay/OpeningBook.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace play::connectfour;
+
+// Connect Four on a 5x4 board is solved in milliseconds
+constexpr int rows = 4;
+constexpr int columns = 5;
+
+std::string bookPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::vector<play::game::BookEntry> solveOpenings(int depth) {
+    Solver solver{ 4 };
+    return play::game::generateOpeningBook<GameState, Move>(GameState::newGame(rows, columns), depth, [&solver](const GameState& position) {
+        return solver.analyse(position);
+    });
+}
+
+std::vector<int> sorted(std::vector<int> moves) {
+    std::sort(moves.begin(), moves.end());
+    return moves;
+}
+
+}
+
+TEST(OpeningBook, ListsEveryPositionOnce) {
+    // 1 + 5 + 25 positions, none of them over, and every position after its children
+    const auto positions = play::game::listBookPositions(GameState::newGame(rows, columns), 2);
+    EXPECT_EQ(31u, positions.size());
+    EXPECT_EQ(GameState::newGame(rows, columns).hash(), positions.back().hash());
+}
+
+TEST(OpeningBook, MapsWrittenBook) {
+    const auto path = bookPath("connectfour-book-test.bin");
+    const auto entries = solveOpenings(4);
+    ASSERT_TRUE(play::game::writeOpeningBook(path, entries));
+
+    play::game::OpeningBook book{ path };
+    ASSERT_TRUE(book.isOpen());
+    EXPECT_EQ(entries.size(), book.size());
+    for (const auto& entry : entries) {
+        const auto* found = book.find(entry.key);
+        ASSERT_NE(nullptr, found);
+        EXPECT_EQ(entry.bestMoves, found->bestMoves);
+        EXPECT_EQ(entry.value, found->value);
+    }
+    EXPECT_EQ(nullptr, book.find(GameState::newGame().dropStone(6).hash())); // no column 6 on the small board
+    book.close();
+    std::filesystem::remove(path);
+}
+
+TEST(OpeningBook, RejectsOtherFiles) {
+    const auto path = bookPath("connectfour-no-book-test.bin");
+    std::ofstream{ path } << "not a book";
+    play::game::OpeningBook book;
+    EXPECT_FALSE(book.open(path));
+    EXPECT_FALSE(book.isOpen());
+    EXPECT_EQ(nullptr, book.find(0));
+    EXPECT_FALSE(book.open(bookPath("connectfour-missing-book-test.bin")));
+    std::filesystem::remove(path);
+}
+
+TEST(BookPlayer, PlaysBookAndFallsBack) {
+    const auto path = bookPath("connectfour-bookplayer-test.bin");
+    ASSERT_TRUE(play::game::writeOpeningBook(path, solveOpenings(2)));
+    const play::game::OpeningBook book{ path };
+    play::agent::BookPlayer<GameState, Move> player{ book, std::make_unique<Solver>(4) };
+    Solver solver{ 4 };
+
+    // in the book
+    auto game = GameState::newGame(rows, columns).dropStone(2);
+    EXPECT_EQ(sorted(solver.selectMoves(game)), sorted(player.selectMoves(game)));
+    EXPECT_EQ(1u, player.bookHits());
+
+    // too deep for the book
+    game = game.dropStone(2).dropStone(1);
+    EXPECT_EQ(sorted(solver.selectMoves(game)), sorted(player.selectMoves(game)));
+    EXPECT_EQ(1u, player.bookHits());
+    std::filesystem::remove(path);
+}
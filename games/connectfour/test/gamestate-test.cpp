@@ -1,8 +1,12 @@
 #include <gtest/gtest.h>
 #include "connectfour/ConnectFour.h"
+#include "twoplayergames/Random.h"
+#include "twoplayergames/gameplay/Perft.h"
 
 #include <algorithm>
 #include <array>
+#include <type_traits>
+#include <utility>
 
 TEST(GameState, PlayMoves) {
     using namespace play::connectfour;
@@ -47,7 +51,8 @@ TEST(GameState, GameOverDraw) {
     EXPECT_TRUE(game.isOver());
 }
 
-bool vectorsSimilar(const std::vector<int>& v1, const std::vector<int>& v2) {
+template<class Moves>
+bool vectorsSimilar(const Moves& v1, const std::vector<int>& v2) {
     return v1.size() == v2.size() && std::is_permutation(v1.begin(), v1.end(), v2.begin());
 }
 
@@ -68,4 +73,201 @@ TEST(GameState, AvailableMoves) {
     }
     game = game.dropStone(5);
     EXPECT_TRUE(vectorsSimilar(game.availableMoves(), { 0, 1, 2, 3, 4, 6 }));
-}
\ No newline at end of file
+}
+
+TEST(GameState, Hash) {
+    using namespace play::connectfour;
+
+    const auto empty = GameState::newGame();
+    const auto a = empty.dropStone(3).dropStone(2).dropStone(4).dropStone(2);
+    const auto b = empty.dropStone(4).dropStone(2).dropStone(3).dropStone(2);
+    EXPECT_EQ(hashOf(a), hashOf(b));
+    EXPECT_NE(hashOf(a), hashOf(empty));
+
+    // same stones, different owners
+    const auto c = empty.dropStone(2).dropStone(3).dropStone(2).dropStone(4);
+    EXPECT_NE(hashOf(a), hashOf(c));
+
+    // an illegal move keeps the state and its hash
+    auto full = empty;
+    for (int i = 0; i < 6; ++i)
+        full = full.dropStone(0);
+    EXPECT_EQ(hashOf(full.dropStone(0)), hashOf(full));
+}
+
+TEST(GameState, Equality) {
+    using namespace play::connectfour;
+
+    const auto empty = GameState::newGame();
+    const auto a = empty.dropStone(3).dropStone(2).dropStone(4).dropStone(2);
+    EXPECT_TRUE(a == empty.dropStone(4).dropStone(2).dropStone(3).dropStone(2));
+    EXPECT_FALSE(a == empty.dropStone(2).dropStone(3).dropStone(2).dropStone(4));
+    EXPECT_FALSE(a == empty);
+
+    // the same stones on a board of another size are another position
+    EXPECT_FALSE(empty == GameState::newGame(6, 8));
+}
+
+TEST(GameState, PlayRandomMove) {
+    using namespace play::connectfour;
+
+    auto game = GameState::newGame();
+    for (int i = 0; i < 6; ++i)
+        game = game.dropStone(0);
+
+    // the random bits pick among the columns that are not full
+    auto lowest = game;
+    playRandomMove(lowest, 0);
+    EXPECT_EQ(hashOf(lowest), hashOf(game.dropStone(1)));
+    auto highest = game;
+    playRandomMove(highest, 0xffffffff);
+    EXPECT_EQ(hashOf(highest), hashOf(game.dropStone(6)));
+
+    while (!isGameOver(game))
+        playRandomMove(game, 0x9e3779b9u * hashOf(game));
+    EXPECT_TRUE(game.board().isFull() || game.winner() != play::game::Player::None);
+}
+
+TEST(GameState, MakeUnmakeMove) {
+    using namespace play::connectfour;
+
+    auto game = GameState::newGame();
+    for (const auto m : { 3, 3, 2, 2, 1, 1 })
+        game = game.dropStone(m);
+    const auto before = game;
+
+    // the last move wins, taking it back has to clear the win
+    makeMove(game, 0);
+    EXPECT_EQ(hashOf(game), hashOf(before.dropStone(0)));
+    EXPECT_TRUE(isGameOver(game));
+    unmakeMove(game, 0);
+    EXPECT_EQ(hashOf(game), hashOf(before));
+    EXPECT_FALSE(isGameOver(game));
+    EXPECT_EQ(game.activePlayer(), before.activePlayer());
+    EXPECT_EQ(game.board().stones(play::game::Player::Player1), before.board().stones(play::game::Player::Player1));
+    EXPECT_EQ(game.board().stones(play::game::Player::Player2), before.board().stones(play::game::Player::Player2));
+}
+
+TEST(GameState, Perft) {
+    using namespace play::connectfour;
+
+    const auto game = GameState::newGame();
+    const std::array<std::uint64_t, 9> leaves{ 1, 7, 49, 343, 2401, 16807, 117649,
+        823536,   // 7 columns were filled at ply 6
+        5686266 }; // games won at ply 7 count as leaves
+    for (int depth = 0; depth < static_cast<int>(leaves.size()); ++depth)
+        EXPECT_EQ((play::game::perft<GameState, Move>(game, depth)), leaves[depth]) << "depth " << depth;
+
+    std::uint64_t divided{ 0 };
+    for (const auto& [move, count] : play::game::perftDivide<GameState, Move>(game, 6))
+        divided += count;
+    EXPECT_EQ(divided, leaves[6]);
+}
+
+namespace {
+// the streak count of the original evaluator: walks from every stone in four directions
+int countStreaks(const play::connectfour::Board& board, const play::game::Player& player, int length) {
+    const std::array<std::array<int, 2>, 4> directions{ { { 1, 0 }, { 0, 1 }, { -1, 1 }, { 1, 1 } } };
+    int count{ 0 };
+    for (int row = 0; row < board.rows(); ++row) {
+        for (int col = 0; col < board.columns(); ++col) {
+            if (board.at(row, col) != player)
+                continue;
+            for (const auto& [dRow, dCol] : directions) {
+                int run{ 0 };
+                for (int r = row, c = col; board.at(r, c) == player; r += dRow, c += dCol)
+                    ++run;
+                count += run >= length ? 1 : 0;
+            }
+        }
+    }
+    return count;
+}
+}
+
+TEST(GameState, IncrementalStreaks) {
+    using namespace play::connectfour;
+    using play::game::Player;
+
+    play::Xoshiro256 random{ 20 };
+    for (int game = 0; game < 50; ++game) {
+        auto state = GameState::newGame();
+        std::vector<GameState> history;
+        std::vector<int> columns;
+        while (!isGameOver(state)) {
+            for (const auto& player : { Player::Player1, Player::Player2 }) {
+                for (int length = 2; length <= 3; ++length)
+                    ASSERT_EQ(state.streaks(player, length), countStreaks(state.board(), player, length));
+            }
+            const auto moves = listLegalMoves(state);
+            const int column = moves[random.below(static_cast<std::uint32_t>(moves.size()))];
+            history.push_back(state);
+            columns.push_back(column);
+            makeMove(state, column);
+        }
+        // taking back all moves restores all counts
+        while (!history.empty()) {
+            unmakeMove(state, columns.back());
+            for (const auto& player : { Player::Player1, Player::Player2 }) {
+                for (int length = 2; length <= 3; ++length)
+                    ASSERT_EQ(state.streaks(player, length), history.back().streaks(player, length));
+            }
+            history.pop_back();
+            columns.pop_back();
+        }
+    }
+}
+
+TEST(GameState, IncrementalStreaksOnTallNarrowBoards) {
+    using namespace play::connectfour;
+    using play::game::Player;
+
+    // two steps across columns may leave the 64 bits, the streak walks must not shift that far
+    play::Xoshiro256 random{ 26 };
+    for (const auto& [rows, columns] : { std::pair{ 20, 3 }, std::pair{ 31, 2 }, std::pair{ 63, 1 } }) {
+        for (int game = 0; game < 20; ++game) {
+            auto state = GameState::newGame(rows, columns);
+            while (!isGameOver(state)) {
+                for (const auto& player : { Player::Player1, Player::Player2 }) {
+                    for (int length = 2; length <= 3; ++length)
+                        ASSERT_EQ(state.streaks(player, length), countStreaks(state.board(), player, length));
+                }
+                const auto moves = listLegalMoves(state);
+                makeMove(state, moves[random.below(static_cast<std::uint32_t>(moves.size()))]);
+            }
+        }
+    }
+}
+
+// fixed sizes keep nothing but the stones and the incremental state
+static_assert(std::is_trivially_copyable_v<play::connectfour::FixedGameState<6, 7>>);
+static_assert(sizeof(play::connectfour::FixedBoard<6, 7>) == 2 * sizeof(std::uint64_t));
+
+TEST(GameState, FixedSizeMatchesRuntimeSize) {
+    using namespace play::connectfour;
+
+    play::Xoshiro256 random{ 25 };
+    for (int game = 0; game < 50; ++game) {
+        auto runtimeSized = GameState::newGame(4, 5);
+        auto fixedSized = FixedGameState<4, 5>::newGame();
+        while (!isGameOver(runtimeSized)) {
+            const auto randomBits = static_cast<std::uint32_t>(random() >> 32);
+            playRandomMove(runtimeSized, randomBits);
+            playRandomMove(fixedSized, randomBits);
+            ASSERT_EQ(hashOf(runtimeSized), hashOf(fixedSized));
+            EXPECT_EQ(runtimeSized.board().occupied(), fixedSized.board().occupied());
+            EXPECT_EQ(runtimeSized.streaks(runtimeSized.activePlayer(), 2), fixedSized.streaks(fixedSized.activePlayer(), 2));
+            EXPECT_EQ(runtimeSized.streaks(runtimeSized.activePlayer(), 3), fixedSized.streaks(fixedSized.activePlayer(), 3));
+        }
+        EXPECT_TRUE(isGameOver(fixedSized));
+        EXPECT_EQ(getWinner(runtimeSized), getWinner(fixedSized));
+    }
+}
+
+TEST(GameState, FixedSizePerft) {
+    using namespace play::connectfour;
+    using Standard = FixedGameState<6, 7>;
+
+    EXPECT_EQ(7u, Standard::MoveList::capacity());
+    EXPECT_EQ((play::game::perft<Standard, Move>(Standard::newGame(), 8)), 5686266u);
+}
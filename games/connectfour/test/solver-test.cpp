@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "connectfour/ConnectFour.h"
+#include "connectfour/Solver.h"
+#include "twoplayergames/Random.h"
+#include "twoplayergames/gameplay/InvisibleMatch.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+using namespace play::connectfour;
+
+GameState playMoves(const std::vector<int>& moves, int rows = 6, int columns = 7) {
+    auto game = GameState::newGame(rows, columns);
+    for (const auto m : moves)
+        game = game.dropStone(m);
+    return game;
+}
+
+// plain alpha-beta search to the end of the game, on the scale of Solver::solve
+int referenceValue(GameState& game, int alpha, int beta) {
+    const int cells = game.board().rows() * game.board().columns();
+    const int stones = Board::countCells(game.board().occupied());
+    if (stones == cells)
+        return 0;
+    for (const auto move : listLegalMoves(game)) {
+        makeMove(game, move);
+        const int value = game.winner() != play::game::Player::None ? (cells + 1 - stones) / 2 : -referenceValue(game, -beta, -alpha);
+        unmakeMove(game, move);
+        if (value >= beta)
+            return value;
+        alpha = std::max(alpha, value);
+    }
+    return alpha;
+}
+
+int referenceValue(GameState game) {
+    return referenceValue(game, -100, 100);
+}
+
+std::vector<int> referenceBestMoves(const GameState& game) {
+    const int value = referenceValue(game);
+    std::vector<int> bestMoves;
+    for (const auto move : listLegalMoves(game)) {
+        auto child = applyMove(move, game);
+        const int cells = game.board().rows() * game.board().columns();
+        const int childValue = child.winner() != play::game::Player::None
+            ? -(cells + 1 - Board::countCells(game.board().occupied())) / 2
+            : referenceValue(child);
+        if (-childValue == value)
+            bestMoves.push_back(move);
+    }
+    return bestMoves;
+}
+
+// positions that are not over, reached by random moves
+std::vector<GameState> randomPositions(int count, int stones) {
+    play::Xoshiro256 random{ 22 };
+    std::vector<GameState> positions;
+    while (static_cast<int>(positions.size()) < count) {
+        auto game = GameState::newGame();
+        for (int i = 0; i < stones && !isGameOver(game); ++i)
+            playRandomMove(game, static_cast<std::uint32_t>(random() >> 32));
+        if (!isGameOver(game))
+            positions.push_back(game);
+    }
+    return positions;
+}
+
+}
+
+TEST(Solver, MatchesFullSearch) {
+    Solver solver{ 4 };
+    for (const auto& game : randomPositions(20, 30)) {
+        EXPECT_EQ(referenceValue(game), solver.solve(game)) << game;
+        auto moves = solver.selectMoves(game);
+        std::sort(moves.begin(), moves.end());
+        EXPECT_EQ(referenceBestMoves(game), moves) << game;
+        // one search gives both
+        auto [value, analysedMoves] = solver.analyse(game);
+        std::sort(analysedMoves.begin(), analysedMoves.end());
+        EXPECT_EQ(referenceValue(game), value) << game;
+        EXPECT_EQ(moves, analysedMoves) << game;
+    }
+}
+
+TEST(Solver, WinsAtOnce) {
+    Solver solver{ 1 };
+    // X can complete the bottom row in column 3
+    const auto game = playMoves({ 0, 0, 1, 1, 2, 2 });
+    EXPECT_EQ(std::vector<int>{ 3 }, solver.selectMoves(game));
+    EXPECT_EQ(18, solver.solve(game));
+}
+
+TEST(Solver, BlocksThreat) {
+    Solver solver{ 1 };
+    // O has to stop three stones of X in column 0
+    const auto game = playMoves({ 0, 4, 0, 4, 0 }, 4, 5);
+    EXPECT_EQ(std::vector<int>{ 0 }, solver.selectMoves(game));
+}
+
+TEST(Solver, LosesAgainstTwoThreats) {
+    Solver solver{ 1 };
+    // X threatens both ends of the bottom row, every move of O loses at once
+    const auto game = playMoves({ 2, 2, 3, 3, 4 });
+    EXPECT_EQ(-18, solver.solve(game));
+    EXPECT_EQ(7u, solver.selectMoves(game).size());
+}
+
+TEST(Solver, SelfPlayReachesValue) {
+    // the value of the empty 5x4 board decides the game between two perfect players
+    Solver solver{ 16 };
+    const int value = solver.solve(GameState::newGame(4, 5));
+    Solver opponent{ 16 };
+    const auto& winner = play::game::playInvisibleMatch<GameState, Move>(&solver, &opponent, 4, 5);
+    if (value > 0)
+        EXPECT_EQ(play::game::Player::Player1, winner);
+    else if (value < 0)
+        EXPECT_EQ(play::game::Player::Player2, winner);
+    else
+        EXPECT_EQ(play::game::Player::None, winner);
+}
@@ -0,0 +1,128 @@
+/* *********************************************************** *
+ * TicTacToe
+ * PerfectPlayer.h
+ * *********************************************************** */
+
+#ifndef TICTACTOE_PERFECT_PLAYER_H
+#define TICTACTOE_PERFECT_PLAYER_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "TicTacToe.h"
+#include "twoplayergames/agent/Agent.h"
+
+namespace play::tictactoe {
+
+struct SolvedPosition {
+    std::int8_t value;       // 1 if the active player wins with perfect play, -1 if it loses, 0 for a draw
+    std::uint16_t bestMoves; // bit i is set if the move to the cell with linear index i keeps the value
+};
+
+namespace detail {
+// every cell is empty, X or O: 3^9 encodings, most of them unreachable
+inline constexpr int numEncodings = 19683;
+
+// the encoding of a board is ternaryOf[marks of X] + 2 * ternaryOf[marks of O]
+constexpr std::array<std::uint16_t, 512> makeTernaryDigits() {
+    std::array<std::uint16_t, 512> ternary{};
+    for (int bits = 0; bits < 512; ++bits) {
+        int power = 1;
+        for (int cell = 0; cell < 9; ++cell, power *= 3)
+            if ((bits >> cell) & 1)
+                ternary[bits] = static_cast<std::uint16_t>(ternary[bits] + power);
+    }
+    return ternary;
+}
+
+inline constexpr auto ternaryOf = makeTernaryDigits();
+
+constexpr int encode(Board::Bitboard x, Board::Bitboard o) {
+    return ternaryOf[x] + 2 * ternaryOf[o];
+}
+
+constexpr bool hasLine(Board::Bitboard marks) {
+    for (const auto mask : Board::winningMasks)
+        if ((marks & mask) == mask)
+            return true;
+    return false;
+}
+
+struct SolvedTable {
+    std::array<SolvedPosition, numEncodings> positions{};
+    std::array<bool, numEncodings> isSolved{};
+
+    // negamax over all positions reachable from (x, o), each solved once
+    constexpr int solve(Board::Bitboard x, Board::Bitboard o, bool xToMove) {
+        const int index = encode(x, o);
+        if (isSolved[index])
+            return positions[index].value;
+        const auto other = xToMove ? o : x;
+        SolvedPosition solved{ 0, 0 };
+        if (hasLine(other))
+            solved.value = -1;
+        else if ((x | o) != Board::fullBoard) {
+            solved.value = -2;
+            for (int cell = 0; cell < 9; ++cell) {
+                const auto mark = static_cast<Board::Bitboard>(1 << cell);
+                if ((x | o) & mark)
+                    continue;
+                const int value = xToMove ? -solve(x | mark, o, false) : -solve(x, o | mark, true);
+                if (value > solved.value) {
+                    solved.value = static_cast<std::int8_t>(value);
+                    solved.bestMoves = 0;
+                }
+                if (value == solved.value)
+                    solved.bestMoves = static_cast<std::uint16_t>(solved.bestMoves | mark);
+            }
+        }
+        positions[index] = solved;
+        isSolved[index] = true;
+        return solved.value;
+    }
+};
+
+constexpr std::array<SolvedPosition, numEncodings> solveAll() {
+    SolvedTable table{};
+    table.solve(0, 0, true);
+    return table.positions;
+}
+}
+
+/* The minimax value and the best moves of every TicTacToe position, computed by the
+ * compiler. Indexed by the encoding of the board, see solvedPosition; positions that can
+ * not be reached in a game are all zero, positions where the game is over have no best
+ * moves.
+ */
+inline constexpr auto solvedPositions = detail::solveAll();
+
+static_assert(solvedPositions[0].value == 0 && solvedPositions[0].bestMoves == Board::fullBoard,
+    "every first move leads to a draw");
+
+inline const SolvedPosition& solvedPosition(const GameState& game) {
+    const auto& board = game.board();
+    return solvedPositions[detail::encode(board.marks(play::game::Player::Player1), board.marks(play::game::Player::Player2))];
+}
+
+/* Perfect play from the solved table: selects all moves that keep the minimax value, the
+ * same moves as a MinimaxPlayer with unlimited depth and the basic evaluator, but with two
+ * table lookups instead of a search. Also an oracle for tests of the search agents.
+ */
+class PerfectPlayer : public play::agent::Agent<GameState, Move> {
+public:
+    std::vector<Move> selectMoves(const GameState& game) override {
+        std::vector<Move> bestMoves;
+        if (game.isOver())
+            return bestMoves;
+        const auto cells = solvedPosition(game).bestMoves;
+        for (int index = 0; index < 9; ++index)
+            if ((cells >> index) & 1)
+                bestMoves.emplace_back(Point{ index / 3, index % 3 });
+        return bestMoves;
+    }
+};
+
+}
+
+#endif
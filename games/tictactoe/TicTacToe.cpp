@@ -4,33 +4,46 @@
  * *********************************************************** */
 
 #include "TicTacToe.h"
+#include "twoplayergames/gameplay/Zobrist.h"
 #include <iostream>
 #include <algorithm>
 
 namespace play::tictactoe {
 
-GameState GameState::newGame() {
-    return GameState{};
+namespace {
+// one key per player and cell, plus one key that toggles with the active player
+constexpr auto zobristKeys = play::game::makeZobristKeys<2 * 9 + 1>(0x7ac7ac70e);
+constexpr auto activePlayerKey = zobristKeys[2 * 9];
+
+std::uint64_t markKey(const play::game::Player& player, const Point& point) {
+    return zobristKeys[(player.id() - 1) * 9 + point.linearIndex()];
+}
 }
 
-GameState::GameState(const Board& board, const play::game::Player& player) :
-    m_board{ board }, m_activePlayer{ player } {
+GameState GameState::newGame() {
+    return GameState{};
 }
 
 bool GameState::isOver() const {
-    return m_board.isFull() || winner() != play::game::Player::None;
+    return m_isOver;
 }
 
 const play::game::Player& GameState::winner() const {
-    return m_board.detectWinner();
+    // hand out the library constants, so the reference outlives this state
+    if (m_winner == play::game::Player::Player1)
+        return play::game::Player::Player1;
+    else if (m_winner == play::game::Player::Player2)
+        return play::game::Player::Player2;
+    else
+        return play::game::Player::None;
 }
 
 bool GameState::isLegalMove(const Move& move) const {
     return m_board.isOnBoard(move.point()) && m_board[move.point()] == play::game::Player::None;
 }
 
-std::vector<Move> GameState::availableMoves() const {
-    std::vector<Move> moves;
+MoveList GameState::availableMoves() const {
+    MoveList moves;
     for (int row = 0; row < 3; ++row) {
         for (int col = 0; col < 3; ++col) {
             if (m_board[Point{ row, col }] == play::game::Player::None)
@@ -41,12 +54,31 @@ std::vector<Move> GameState::availableMoves() const {
 }
 
 GameState GameState::applyMove(const Move& move) const {
-    if (!isOver() && m_board.isOnBoard(move.point()) && m_board[move.point()] == play::game::Player::None) {
-        Board nextBoard{ m_board };
-        nextBoard.placeMark(move.point(), m_activePlayer);
-        return GameState(nextBoard, m_activePlayer.other());
-    } else
-        return *this;
+    GameState next{ *this };
+    next.placeMark(move);
+    return next;
+}
+
+void GameState::placeMark(const Move& move) {
+    if (!isOver() && isLegalMove(move)) {
+        m_board.placeMark(move.point(), m_activePlayer);
+        m_hash ^= markKey(m_activePlayer, move.point()) ^ activePlayerKey;
+        // only the player who just moved can have completed a line
+        if (m_board.isWinner(m_activePlayer))
+            m_winner = m_activePlayer;
+        m_isOver = m_winner != play::game::Player::None || m_board.isFull();
+        m_activePlayer = m_activePlayer.other();
+    }
+}
+
+void GameState::removeMark(const Move& move) {
+    if (m_board.isOnBoard(move.point()) && m_board[move.point()] != play::game::Player::None) {
+        m_activePlayer = m_activePlayer.other();
+        m_board.placeMark(move.point(), play::game::Player::None);
+        m_hash ^= markKey(m_activePlayer, move.point()) ^ activePlayerKey;
+        m_winner = play::game::Player::None;
+        m_isOver = false;
+    }
 }
 
 bool Board::isOnBoard(const Point& p) const {
@@ -54,15 +86,23 @@ bool Board::isOnBoard(const Point& p) const {
 }
 
 const play::game::Player& Board::operator[](const Point& p) const {
-    if (isOnBoard(p))
-        return m_marks[p.linearIndex()];
-    else
-        return play::game::Player::None;
+    if (isOnBoard(p)) {
+        const Bitboard cell = 1 << p.linearIndex();
+        if (m_marks[0] & cell)
+            return play::game::Player::Player1;
+        else if (m_marks[1] & cell)
+            return play::game::Player::Player2;
+    }
+    return play::game::Player::None;
 }
 
 bool Board::placeMark(const Point& point, const play::game::Player& player) {
     if (isOnBoard(point)) {
-        m_marks[point.linearIndex()] = player;
+        const Bitboard cell = 1 << point.linearIndex();
+        m_marks[0] &= ~cell;
+        m_marks[1] &= ~cell;
+        if (player != play::game::Player::None)
+            m_marks[player.id() - 1] |= cell;
         return true;
     } else {
         return false;
@@ -70,7 +110,13 @@ bool Board::placeMark(const Point& point, const play::game::Player& player) {
 }
 
 bool Board::isFull() const {
-    return std::none_of(m_marks.begin(), m_marks.end(), [](const play::game::Player& p) { return p == play::game::Player::None; });
+    return occupied() == fullBoard;
+}
+
+Board::Bitboard Board::marks(const play::game::Player& player) const {
+    if (player == play::game::Player::None)
+        return 0;
+    return m_marks[player.id() - 1];
 }
 
 const play::game::Player& Board::detectWinner() const {
@@ -83,35 +129,11 @@ const play::game::Player& Board::detectWinner() const {
 }
 
 bool Board::isWinner(const play::game::Player& player) const {
-    for (int i = 0; i < 3; ++i)
-        if (playerWinsRow(player, i) || playerWinsCol(player, i))
+    const auto playerMarks = marks(player);
+    for (const auto mask : winningMasks)
+        if ((playerMarks & mask) == mask)
             return true;
-    return playerWinsDiag(player);
-}
-
-bool Board::playerWinsRow(const play::game::Player& player, int row) const {
-    for (int col = 0; col < 3; ++col)
-        if ((*this)[Point{ row, col }] != player)
-            return false;
-    return true;
-}
-
-bool Board::playerWinsCol(const play::game::Player& player, int col) const {
-    for (int row = 0; row < 3; ++row)
-        if ((*this)[Point{ row, col }] != player)
-            return false;
-    return true;
-}
-
-bool Board::playerWinsDiag(const play::game::Player& player) const {
-    bool diag1 = true, diag2 = true;
-    for (int i = 0; i < 3; ++i) {
-        if ((*this)[Point{ i, i }] != player)
-            diag1 = false;
-        if ((*this)[Point{ i, 2 - i }] != player)
-            diag2 = false;
-    }
-    return diag1 || diag2;
+    return false;
 }
 
 namespace {
@@ -140,7 +162,7 @@ std::ostream& operator<<(std::ostream& ostr, const Board& board) {
 
 // ---- Interface to game library
 
-std::vector<Move> listLegalMoves(const GameState& game) { 
+MoveList listLegalMoves(const GameState& game) { 
     return game.availableMoves(); 
 }
 
@@ -156,6 +178,43 @@ bool isGameOver(const GameState& game) {
     return game.isOver();
 }
 
+std::uint64_t hashOf(const GameState& game) {
+    return game.hash();
+}
+
+int moveIndex(const Move& move, const GameState& game) {
+    return move.point().linearIndex();
+}
+
+int movePriority(const Move& move, const GameState& game) {
+    // the center is part of four lines, corners of three and edges of two
+    static constexpr std::array<int, 9> linesThroughCell{ 3, 2, 3, 2, 4, 2, 3, 2, 3 };
+    return linesThroughCell[move.point().linearIndex()];
+}
+
+void playRandomMove(GameState& game, std::uint32_t randomBits) {
+    const auto freeCells = ~game.board().occupied() & 0x1ff;
+    int numFree{ 0 };
+    for (auto cells = freeCells; cells != 0; cells &= cells - 1)
+        ++numFree;
+    // scale the random bits to [0, numFree) with a multiplication instead of a division
+    auto choice = static_cast<int>((std::uint64_t{ randomBits } * numFree) >> 32);
+    for (int index = 0; index < 9; ++index) {
+        if ((freeCells >> index) & 1 && choice-- == 0) {
+            game.placeMark(Move{ Point{ index / 3, index % 3 } });
+            return;
+        }
+    }
+}
+
+void makeMove(GameState& game, const Move& move) {
+    game.placeMark(move);
+}
+
+void unmakeMove(GameState& game, const Move& move) {
+    game.removeMark(move);
+}
+
 play::game::Player getActivePlayer(const GameState& game) {
     return game.activePlayer();
 }
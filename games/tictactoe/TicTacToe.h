@@ -7,9 +7,12 @@
 #define TICTACTOE_BOARD_H
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <memory>
 
+#include "twoplayergames/gameplay/MoveList.h"
 #include "twoplayergames/gameplay/Player.h"
 
 namespace play::tictactoe {
@@ -34,24 +37,34 @@ private:
     Point m_p;
 };
 
+inline constexpr std::size_t maxLegalMoves = 9;
+using MoveList = play::game::MoveList<Move, maxLegalMoves>;
+
 class Board {
+    /* Bitboard representation: one 9-bit mask per player, bit i is the cell with linear index i. */
 public:
+    using Bitboard = std::uint16_t;
+
     bool isOnBoard(const Point& p) const;
     const play::game::Player& operator[](const Point& p) const;
     bool placeMark(const Point& point, const play::game::Player& player);
     bool isFull() const;
 
     const play::game::Player& detectWinner() const;
-private:
-    std::array<play::game::Player, 9> m_marks{
-        play::game::Player::None, play::game::Player::None, play::game::Player::None,
-        play::game::Player::None, play::game::Player::None, play::game::Player::None,
-        play::game::Player::None, play::game::Player::None, play::game::Player::None };
-
     bool isWinner(const play::game::Player& player) const;
-    bool playerWinsRow(const play::game::Player& player, int row) const;
-    bool playerWinsCol(const play::game::Player& player, int col) const;
-    bool playerWinsDiag(const play::game::Player& player) const;
+
+    Bitboard marks(const play::game::Player& player) const;
+    Bitboard occupied() const { return m_marks[0] | m_marks[1]; }
+    bool operator==(const Board& other) const { return m_marks == other.m_marks; }
+
+    static constexpr Bitboard fullBoard = 0x1ff;
+    static constexpr std::array<Bitboard, 8> winningMasks{
+        0007, 0070, 0700, // rows
+        0111, 0222, 0444, // columns
+        0421, 0124        // diagonals
+    };
+private:
+    std::array<Bitboard, 2> m_marks{ 0, 0 };
 
     friend std::ostream& operator<<(std::ostream& ostr, const Board& board);
 };
@@ -64,24 +77,37 @@ public:
     const play::game::Player& winner() const;
     const play::game::Player& activePlayer() const { return m_activePlayer; }
     
-    std::vector<Move> availableMoves() const;
+    MoveList availableMoves() const;
     GameState applyMove(const Move& move) const;
+    void placeMark(const Move& move); // applies the move in place
+    void removeMark(const Move& move); // undoes placeMark(move) on a state that was not over
     bool isLegalMove(const Move& move) const;
     const Board& board() const { return m_board; }
+    std::uint64_t hash() const { return m_hash; }
+    // same marks and same player to move; unlike equal hashes, this rules out collisions
+    bool operator==(const GameState& other) const { return m_board == other.m_board && m_activePlayer == other.m_activePlayer; }
 private:
     GameState() = default;
-    GameState(const Board& board, const play::game::Player& next_player);
 
     Board m_board{};
     play::game::Player m_activePlayer{ play::game::Player::Player1 };
+    play::game::Player m_winner{ play::game::Player::None };
+    bool m_isOver{ false };
+    std::uint64_t m_hash{ 0 }; // Zobrist key, updated with every placed mark
 };
 
 // ---- Interface to game library
 
-std::vector<Move> listLegalMoves(const GameState& game);
+MoveList listLegalMoves(const GameState& game);
 bool isLegalMove(const Move& move, const GameState& game);
 GameState applyMove(const Move& move, const GameState& game);
 bool isGameOver(const GameState& game);
+std::uint64_t hashOf(const GameState& game);
+int moveIndex(const Move& move, const GameState& game);
+int movePriority(const Move& move, const GameState& game);
+void playRandomMove(GameState& game, std::uint32_t randomBits);
+void makeMove(GameState& game, const Move& move);
+void unmakeMove(GameState& game, const Move& move);
 play::game::Player getActivePlayer(const GameState& game);
 const play::game::Player& getWinner(const GameState& game);
 Move askForMove(const GameState& state);
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include "tictactoe/PerfectPlayer.h"
+#include "tictactoe/TicTacToe.h"
+#include "twoplayergames/agent/MinimaxPlayer.h"
+#include "twoplayergames/agent/RandomPlayer.h"
+#include "twoplayergames/gameplay/BookGeneration.h"
+#include "twoplayergames/gameplay/Tournament.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::vector<int> cellsOf(const std::vector<play::tictactoe::Move>& moves) {
+    std::vector<int> cells;
+    for (const auto& m : moves)
+        cells.push_back(m.point().linearIndex());
+    std::sort(cells.begin(), cells.end());
+    return cells;
+}
+
+}
+
+TEST(MinimaxPlayer, TranspositionTableKeepsResult) {
+    using namespace play::tictactoe;
+    using Player = play::agent::MinimaxPlayer<GameState, Move>;
+
+    auto game = GameState::newGame();
+    const std::vector<Move> moves{ Move{{ 1, 1 }}, Move{{ 0, 0 }}, Move{{ 2, 2 }}, Move{{ 0, 2 }} };
+    for (const auto& m : moves) {
+        Player plain{ -1, 0 };
+        Player cached{ -1, 1 };
+        EXPECT_EQ(cellsOf(plain.selectMoves(game)), cellsOf(cached.selectMoves(game)));
+        game = applyMove(m, game);
+    }
+}
+
+TEST(MinimaxPlayer, IterativeDeepeningFinishesSolvedTree) {
+    using namespace play::tictactoe;
+    using Player = play::agent::MinimaxPlayer<GameState, Move>;
+
+    // the tree is searched to the end long before the budget is used up
+    const auto start = std::chrono::steady_clock::now();
+    auto game = GameState::newGame().applyMove(Move{ { 0, 0 } });
+    Player timed{ std::chrono::milliseconds{ 5000 } };
+    Player full{};
+    EXPECT_EQ(cellsOf(timed.selectMoves(game)), cellsOf(full.selectMoves(game)));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{ 5000 });
+}
+
+TEST(MinimaxPlayer, ParallelSearchFindsSameMoves) {
+    using namespace play::tictactoe;
+    using Player = play::agent::MinimaxPlayer<GameState, Move>;
+    using play::agent::ParallelSearch;
+
+    auto game = GameState::newGame();
+    const std::vector<Move> moves{ Move{{ 0, 1 }}, Move{{ 1, 1 }}, Move{{ 2, 1 }} };
+    for (const auto& m : moves) {
+        Player sequential{};
+        Player rootSplitting{ -1, 16, 3, ParallelSearch::RootSplitting };
+        Player lazySMP{ -1, 16, 3, ParallelSearch::LazySMP };
+        const auto expected = cellsOf(sequential.selectMoves(game));
+        EXPECT_EQ(expected, cellsOf(rootSplitting.selectMoves(game)));
+        EXPECT_EQ(expected, cellsOf(lazySMP.selectMoves(game)));
+        game = applyMove(m, game);
+    }
+}
+
+TEST(Tournament, PerfectPlayNeverLoses) {
+    using namespace play::tictactoe;
+    using namespace play::game;
+
+    std::atomic<int> createdAgents{ 0 };
+    const AgentFactory<GameState, Move> perfect = [&] {
+        ++createdAgents;
+        return std::make_unique<play::agent::MinimaxPlayer<GameState, Move>>(-1, 1);
+    };
+    const AgentFactory<GameState, Move> random = [&] {
+        ++createdAgents;
+        return std::make_unique<play::agent::RandomPlayer<GameState, Move>>();
+    };
+
+    std::atomic<int> reportedGames{ 0 };
+    const auto result = playTournament<GameState, Move>(perfect, random, TournamentOptions{ 100, 4, 7 },
+        [&](int, MatchOutcome outcome, const TournamentResult& standings) {
+            ++reportedGames;
+            EXPECT_NE(outcome, MatchOutcome::SecondAgentWins);
+            EXPECT_EQ(standings.games, standings.firstAgentWins + standings.secondAgentWins + standings.draws);
+        });
+    EXPECT_EQ(result.games, 100);
+    EXPECT_EQ(reportedGames, 100);
+    EXPECT_EQ(result.secondAgentWins, 0);
+    EXPECT_GT(result.firstAgentWins, 0);
+    // one pair of agents per thread
+    EXPECT_EQ(createdAgents, 8);
+}
+
+TEST(Tournament, SameSeedPlaysSameGames) {
+    using namespace play::tictactoe;
+    using namespace play::game;
+
+    const AgentFactory<GameState, Move> random = [] { return std::make_unique<play::agent::RandomPlayer<GameState, Move>>(); };
+    const auto play = [&](std::uint64_t seed) {
+        std::vector<int> outcomes(200);
+        playTournament<GameState, Move>(random, random, TournamentOptions{ 200, 3, seed },
+            [&](int game, MatchOutcome outcome, const TournamentResult&) { outcomes[game] = static_cast<int>(outcome); });
+        return outcomes;
+    };
+    EXPECT_EQ(play(1), play(1));
+    EXPECT_NE(play(1), play(2));
+}
+
+TEST(Tournament, EveryThreadPlaysBothColours) {
+    using namespace play::tictactoe;
+    using namespace play::game;
+
+    const AgentFactory<GameState, Move> random = [] { return std::make_unique<play::agent::RandomPlayer<GameState, Move>>(); };
+    std::mutex mutex;
+    std::map<std::thread::id, std::set<int>> startingAgents;
+    play::seedThreadRandom(3);
+    playTournament<GameState, Move>(random, random, TournamentOptions{ 40, 4, 1 },
+        [&](int game, MatchOutcome, const TournamentResult&) {
+            std::lock_guard<std::mutex> lock{ mutex };
+            startingAgents[std::this_thread::get_id()].insert(game % 2);
+        });
+    EXPECT_FALSE(startingAgents.empty());
+    for (const auto& [thread, starts] : startingAgents)
+        EXPECT_EQ(starts.size(), 2u);
+    // the calling thread plays too, but keeps its generator
+    play::Xoshiro256 expected{ 3 };
+    EXPECT_EQ(play::threadRandom()(), expected());
+}
+
+TEST(Tournament, KeepsGeneratorWhenAgentThrows) {
+    using namespace play::tictactoe;
+    using namespace play::game;
+
+    const AgentFactory<GameState, Move> failing = []() -> std::unique_ptr<play::agent::Agent<GameState, Move>> { throw std::runtime_error{ "no agent" }; };
+    play::seedThreadRandom(4);
+    EXPECT_THROW((playTournament<GameState, Move>(failing, failing, TournamentOptions{ 2, 1, 1 }, {})), std::runtime_error);
+    play::Xoshiro256 expected{ 4 };
+    EXPECT_EQ(play::threadRandom()(), expected());
+}
+
+TEST(PerfectPlayer, MatchesMinimaxEverywhere) {
+    using namespace play::tictactoe;
+
+    // every position of a game that is not over yet
+    const auto positions = play::game::listBookPositions(GameState::newGame(), 9);
+    EXPECT_EQ(4520u, positions.size());
+    PerfectPlayer perfect;
+    play::agent::MinimaxPlayer<GameState, Move> minimax{ -1, 1 };
+    play::game::BasicIntEvaluator<GameState> evaluator;
+    for (const auto& game : positions) {
+        const auto bestMoves = perfect.selectMoves(game);
+        EXPECT_EQ(cellsOf(minimax.selectMoves(game)), cellsOf(bestMoves)) << game;
+        // the value is the value of the positions after the best moves
+        const auto next = applyMove(bestMoves.front(), game);
+        const int nextValue = isGameOver(next) ? evaluator.evaluateGameState(next) : solvedPosition(next).value;
+        EXPECT_EQ(solvedPosition(game).value, -nextValue) << game;
+    }
+}
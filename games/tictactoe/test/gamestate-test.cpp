@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "tictactoe/TicTacToe.h"
+#include "twoplayergames/gameplay/Perft.h"
 #include <algorithm>
+#include <array>
 
 TEST(GameState, PlayMoves) {
     using namespace play::tictactoe;
@@ -71,6 +73,31 @@ TEST(GameState, GameOverWinnerX) {
     EXPECT_EQ(s.winner(), Player::Player1);
 }
 
+TEST(GameState, GameOverWinOnLastMove) {
+    using namespace play::tictactoe;
+    using namespace play::game;
+
+    const std::array<Move, 8> moves{
+        Move{{ 0, 1 }}, Move{{ 0, 0 }},
+        Move{{ 0, 2 }}, Move{{ 1, 1 }},
+        Move{{ 1, 0 }}, Move{{ 2, 0 }},
+        Move{{ 1, 2 }}, Move{{ 2, 1 }}
+    };
+
+    auto s = GameState::newGame();
+    for (const Move& m : moves)
+        s = s.applyMove(m);
+    EXPECT_FALSE(s.isOver());
+    s = s.applyMove(Move{ { 2, 2 } });
+    EXPECT_TRUE(s.isOver());
+    EXPECT_TRUE(s.board().isFull());
+    EXPECT_EQ(s.winner(), Player::Player1);
+
+    auto after = s.applyMove(Move{ { 2, 2 } }); // game is over, state stays unchanged
+    EXPECT_EQ(after.winner(), Player::Player1);
+    EXPECT_EQ(after.activePlayer(), s.activePlayer());
+}
+
 std::vector<play::tictactoe::Move> generateAllMoves() {
     std::vector<play::tictactoe::Move> moves;
     for (int row = 0; row < 3; ++row)
@@ -97,4 +124,63 @@ TEST(GameState, AvailableMoves) {
     EXPECT_TRUE(std::is_permutation(moves.begin(), moves.end(), allMoves.begin(), allMoves.end()));
 
     // TODO Test after a few moves
-}
\ No newline at end of file
+}
+
+TEST(GameState, Hash) {
+    using namespace play::tictactoe;
+
+    const auto empty = GameState::newGame();
+    const auto a = empty.applyMove(Move{ { 0, 0 } }).applyMove(Move{ { 1, 1 } }).applyMove(Move{ { 2, 2 } });
+    const auto b = empty.applyMove(Move{ { 2, 2 } }).applyMove(Move{ { 1, 1 } }).applyMove(Move{ { 0, 0 } });
+    EXPECT_EQ(hashOf(a), hashOf(b));
+    EXPECT_NE(hashOf(a), hashOf(empty));
+
+    const auto c = empty.applyMove(Move{ { 1, 1 } }).applyMove(Move{ { 0, 0 } }).applyMove(Move{ { 2, 2 } });
+    EXPECT_NE(hashOf(a), hashOf(c));
+    EXPECT_EQ(hashOf(a.applyMove(Move{ { 1, 1 } })), hashOf(a));
+}
+
+TEST(GameState, PlayRandomMove) {
+    using namespace play::tictactoe;
+
+    const auto game = GameState::newGame().applyMove(Move{ { 0, 0 } });
+
+    // the random bits pick among the free cells in the order of their linear index
+    auto lowest = game;
+    playRandomMove(lowest, 0);
+    EXPECT_EQ(hashOf(lowest), hashOf(game.applyMove(Move{ { 0, 1 } })));
+    auto highest = game;
+    playRandomMove(highest, 0xffffffff);
+    EXPECT_EQ(hashOf(highest), hashOf(game.applyMove(Move{ { 2, 2 } })));
+}
+
+TEST(GameState, MakeUnmakeMove) {
+    using namespace play::tictactoe;
+
+    auto game = GameState::newGame().applyMove(Move{ { 0, 0 } }).applyMove(Move{ { 1, 0 } })
+        .applyMove(Move{ { 0, 1 } }).applyMove(Move{ { 1, 1 } });
+    const auto before = game;
+
+    // the last move wins, taking it back has to clear the win
+    makeMove(game, Move{ { 0, 2 } });
+    EXPECT_EQ(game.winner(), play::game::Player::Player1);
+    unmakeMove(game, Move{ { 0, 2 } });
+    EXPECT_EQ(hashOf(game), hashOf(before));
+    EXPECT_FALSE(isGameOver(game));
+    EXPECT_EQ(game.winner(), play::game::Player::None);
+    EXPECT_EQ(game.activePlayer(), before.activePlayer());
+    EXPECT_EQ(game.board().occupied(), before.board().occupied());
+}
+
+TEST(GameState, Perft) {
+    using namespace play::tictactoe;
+
+    const auto game = GameState::newGame();
+    const std::array<std::uint64_t, 7> leaves{ 1, 9, 72, 504, 3024, 15120, 56160 };
+    for (int depth = 0; depth < static_cast<int>(leaves.size()); ++depth)
+        EXPECT_EQ((play::game::perft<GameState, Move>(game, depth)), leaves[depth]) << "depth " << depth;
+
+    // the number of possible games
+    EXPECT_EQ((play::game::perft<GameState, Move>(game, -1)), 255168u);
+    EXPECT_EQ((play::game::perft<GameState, Move>(game, 9)), 255168u);
+}
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <iomanip>
 #include <memory>
+#include <mutex>
 
 #include "twoplayergames/agent/Agent.h"
 #include "twoplayergames/agent/InteractivePlayer.h"
@@ -11,6 +12,7 @@
 
 #include "twoplayergames/gameplay/ConsoleGame.h"
 #include "twoplayergames/gameplay/InvisibleMatch.h"
+#include "twoplayergames/gameplay/Tournament.h"
 
 #include "tictactoe/TicTacToe.h"
 #include "connectfour/ConnectFour.h"
@@ -44,43 +46,45 @@ void mainInvisibleTournament() {
     using Move = Game::Move;
     using GameState = Game::GameState;
 
-    auto bot1 = std::make_unique<play::agent::MinimaxPlayer<GameState, Move, play::connectfour::ConnectFourEvaluator_Streaks>>(3);
-    auto bot2 = std::make_unique<play::agent::MCTSPlayer<GameState, Move, 2000>>();
+    const play::game::AgentFactory<GameState, Move> createBot1 = [] {
+        return std::make_unique<play::agent::MinimaxPlayer<GameState, Move, play::connectfour::ConnectFourEvaluator_Streaks>>(3);
+    };
+    const play::game::AgentFactory<GameState, Move> createBot2 = [] {
+        return std::make_unique<play::agent::MCTSPlayer<GameState, Move, 2000>>();
+    };
 
-    int player1Win = 0;
-    int player2Win = 0;
-    constexpr int rounds = 1000;
+    play::game::TournamentOptions options;
+    options.games = 1000;
+    const int rounds = options.games;
 
-    for (int round = 0; round < rounds; ++round) {
-        const auto& winner = play::game::playInvisibleMatch<GameState, Move>(bot1.get(), bot2.get());
-        std::cout << "Round " << std::setw(4) << round + 1 << ": ";
-        if (winner == play::game::Player::Player1) {
-            ++player1Win;
-            std::cout << "Player 1";
-        } else if (winner == play::game::Player::Player2) {
-            ++player2Win;
-            std::cout << "Player 2";
-        } else {
-            std::cout << "Draw    ";
-        }
+    std::mutex outputMutex;
+    const auto printProgress = [&](int game, play::game::MatchOutcome outcome, const play::game::TournamentResult& standings) {
+        std::lock_guard<std::mutex> lock{ outputMutex };
+        std::cout << "Round " << std::setw(4) << game + 1 << ": ";
+        if (outcome == play::game::MatchOutcome::FirstAgentWins)
+            std::cout << "Minimax";
+        else if (outcome == play::game::MatchOutcome::SecondAgentWins)
+            std::cout << "MCTS   ";
+        else
+            std::cout << "Draw   ";
         std::cout << " (";
-        printPlayerPercent(player1Win, round);
+        printPlayerPercent(standings.firstAgentWins, standings.games - 1);
         std::cout << " | ";
-        printPlayerPercent(player2Win, round);
+        printPlayerPercent(standings.secondAgentWins, standings.games - 1);
         std::cout << ")\n";
-    }
+    };
+    const auto result = play::game::playTournament<GameState, Move>(createBot1, createBot2, options, printProgress);
 
     std::cout << "\nTournament result:\n";
     std::cout << "Rounds played: " << rounds << '\n';
-    std::cout << "  Player 1 wins: " << std::setw(4) << player1Win << " (";
-    printPlayerPercent(player1Win, rounds);
+    std::cout << "  Minimax wins: " << std::setw(4) << result.firstAgentWins << " (";
+    printPlayerPercent(result.firstAgentWins, rounds);
     std::cout << ")\n";
-    std::cout << "  Player 2 wins: " << std::setw(4) << player2Win << " (";
-    printPlayerPercent(player2Win, rounds);
+    std::cout << "  MCTS wins   : " << std::setw(4) << result.secondAgentWins << " (";
+    printPlayerPercent(result.secondAgentWins, rounds);
     std::cout << ")\n";
-    int drawCount = rounds - player1Win - player2Win;
-    std::cout << "  Draw         : " << std::setw(4) << drawCount << " (";
-    printPlayerPercent(drawCount, rounds);
+    std::cout << "  Draw        : " << std::setw(4) << result.draws << " (";
+    printPlayerPercent(result.draws, rounds);
     std::cout << ")\n";
 }
 
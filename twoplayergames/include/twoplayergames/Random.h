@@ -0,0 +1,81 @@
+/* *********************************************************** *
+ * Random.h
+ * *********************************************************** */
+
+#ifndef TWOPLAYERGAMES_RANDOM_H
+#define TWOPLAYERGAMES_RANDOM_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+namespace play {
+
+// One step of splitmix64: advances the state and returns the next well-mixed 64-bit value.
+constexpr std::uint64_t splitmix64(std::uint64_t& state) {
+    state += 0x9e3779b97f4a7c15ull;
+    std::uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+/* xoshiro256** by Blackman and Vigna: a small and fast generator with 256 bits of state
+ * that satisfies the UniformRandomBitGenerator requirements, so it works with std::shuffle
+ * and the std distributions. The same seed always gives the same sequence; the state is
+ * filled from the seed with splitmix64, as recommended by the authors.
+ * A generator must not be shared between threads, see threadRandom().
+ */
+class Xoshiro256 {
+public:
+    using result_type = std::uint64_t;
+
+    explicit Xoshiro256(std::uint64_t seed = 0) {
+        for (auto& word : s)
+            word = splitmix64(seed);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const auto result = rotl(s[1] * 5, 7) * 9;
+        const auto t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // A number in [0, n), by scaling the upper 32 bits instead of a division; the bias is
+    // below n / 2^32, which is irrelevant for choosing among moves.
+    std::uint32_t below(std::uint32_t n) {
+        return static_cast<std::uint32_t>(((*this)() >> 32) * n >> 32);
+    }
+
+private:
+    std::array<std::uint64_t, 4> s;
+
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+/* The generator of the calling thread. It is seeded from std::random_device when a thread
+ * uses it first; seedThreadRandom makes everything that draws from it afterwards on this
+ * thread reproducible, e.g. a match and the agents created for it.
+ */
+inline Xoshiro256& threadRandom() {
+    thread_local Xoshiro256 generator{ (std::uint64_t{ std::random_device{}() } << 32) | std::random_device{}() };
+    return generator;
+}
+
+inline void seedThreadRandom(std::uint64_t seed) {
+    threadRandom() = Xoshiro256{ seed };
+}
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+/* *********************************************************** *
+ * ThreadPool.h
+ * *********************************************************** */
+
+#ifndef TWOPLAYERGAMES_THREAD_POOL_H
+#define TWOPLAYERGAMES_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace play {
+
+/* Fixed set of worker threads that execute submitted tasks in submission order.
+ * The destructor finishes all queued tasks before joining the workers.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned numThreads) {
+        for (unsigned i = 0; i < numThreads; ++i)
+            workers.emplace_back([this] { work(); });
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    template<class Task>
+    auto submit(Task&& task) -> std::future<std::invoke_result_t<Task>> {
+        using Result = std::invoke_result_t<Task>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<Task>(task));
+        auto result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            tasks.emplace([packaged] { (*packaged)(); });
+        }
+        wakeUp.notify_one();
+        return result;
+    }
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    bool stopping{ false };
+
+    void work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock{ mutex };
+                wakeUp.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+};
+
+}
+
+#endif
@@ -13,6 +13,8 @@ template<class GameState, class Move>
 class Agent {
 public:
     virtual std::vector<Move> selectMoves(const GameState& state) = 0;
+
+    virtual ~Agent() = default;
 };
 
 }
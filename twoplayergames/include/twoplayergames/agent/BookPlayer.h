@@ -0,0 +1,54 @@
+/* *********************************************************** *
+ * BookPlayer.h
+ * *********************************************************** */
+
+#ifndef AGENT_BOOK_PLAYER_H
+#define AGENT_BOOK_PLAYER_H
+
+#include "Agent.h"
+#include "../gameplay/OpeningBook.h"
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace play::agent {
+
+/* Plays the best moves of an opening book and asks another agent for positions the book
+ * does not contain. The book is only read, so one book can serve the agents of all threads
+ * of a tournament; it has to outlive the agent.
+ */
+template<class GameState, class Move>
+class BookPlayer : public Agent<GameState, Move> {
+public:
+    BookPlayer(const play::game::OpeningBook& book, std::unique_ptr<Agent<GameState, Move>> fallback) :
+        book{ book }, fallback{ std::move(fallback) } {
+    }
+
+    std::vector<Move> selectMoves(const GameState& game) override {
+        if (const auto* entry = book.find(hashOf(game))) {
+            std::vector<Move> bestMoves;
+            for (const auto& move : listLegalMoves(game)) {
+                const auto index = moveIndex(move, game);
+                if (index >= 0 && index < 32 && ((entry->bestMoves >> index) & 1) != 0)
+                    bestMoves.push_back(move);
+            }
+            if (!bestMoves.empty()) {
+                ++hits;
+                return bestMoves;
+            }
+        }
+        return fallback->selectMoves(game);
+    }
+
+    // number of moves taken from the book
+    unsigned long long bookHits() const { return hits; }
+
+private:
+    const play::game::OpeningBook& book;
+    std::unique_ptr<Agent<GameState, Move>> fallback;
+    unsigned long long hits{ 0 };
+};
+
+}
+
+#endif
@@ -5,36 +5,104 @@
 #ifndef AGENT_MCTS_PLAYER_H
 #define AGENT_MCTS_PLAYER_H
 
-#include <random>
+#include <atomic>
+#include <cstdint>
 #include <cmath>
 #include <algorithm>
 #include <numeric>
+#include <future>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-#include "RandomPlayer.h"
-#include "../random_selection.h"
+#include "Agent.h"
+#include "NodeArena.h"
+#include "../Random.h"
+#include "../ThreadPool.h"
+#include "../gameplay/GameTraits.h"
 #include "../gameplay/Player.h"
 
 namespace play::agent {
 
-namespace {
+namespace detail {
 
+/* The state of one search thread: its random number generator and the arena for the nodes
+ * it creates. The spare arena takes the part of a tree that is kept for the next search.
+ */
+struct MCTSWorker {
+    play::Xoshiro256 g;
+    NodeArena arena;
+    NodeArena spareArena;
+};
+
+/* A node of the search tree. Several threads may work on one tree at the same time:
+ * the statistics are atomic, children are added under a per-node spin lock and are
+ * read by other threads only once the node is fully expanded. Every node on the path
+ * of a running iteration carries a virtual loss, so concurrent iterations spread over
+ * different branches.
+ * Nodes live in the arena of the worker that created them. The children of a node are
+ * stored contiguously in one array that is allocated with the first child.
+ */
 template<class GameState, class Move>
 class MCTSNode {
 public:
-    MCTSNode(const GameState &state) : MCTSNode(state, nullptr) {}
+    static MCTSNode* createRoot(const GameState& state, MCTSWorker& worker) {
+        return worker.arena.create<MCTSNode>(state, nullptr, worker);
+    }
+
+    /* Runs the destructors of a tree created by createRoot; the memory is released by
+     * resetting the arenas. For games with trivially destructible states and moves there
+     * is nothing to do, so dropping a tree costs O(1).
+     */
+    static void destroyTree(MCTSNode* root) {
+        if constexpr (!std::is_trivially_destructible_v<GameState> || !std::is_trivially_destructible_v<Move>) {
+            const int numChildren = root->evaluatedMoves;
+            for (int i = 0; i < numChildren; ++i)
+                destroyTree(&root->children[i]);
+            std::destroy_n(root->availableMoves, root->numMoves);
+            root->~MCTSNode();
+        }
+    }
 
-    void evaluateMoves() {
-        auto node = selectMCTSNode();
-        node = node->expand();
-        auto result = node->simulate();
-        node->backpropagate(result);
+    // Copies the tree below this node with all statistics into the arena; the copy is a root.
+    MCTSNode* copyTree(NodeArena& arena) const {
+        auto* copy = arena.allocate<MCTSNode>();
+        copyInto(copy, nullptr, arena);
+        return copy;
+    }
+
+    // Finds the node for target in the first levels of the tree; hash is hashOf(target).
+    MCTSNode* findState(const GameState& target, std::uint64_t hash, int maxDepth) {
+        if (hashOf(state) == hash && state == target)
+            return this;
+        if (maxDepth > 0) {
+            const int numChildren = evaluatedMoves;
+            for (int i = 0; i < numChildren; ++i) {
+                if (auto* node = children[i].findState(target, hash, maxDepth - 1))
+                    return node;
+            }
+        }
+        return nullptr;
+    }
+
+    int getNumVisits() const { return numVisits; }
+
+    // With a shared tree, the iteration marks its path with a virtual loss until it is backpropagated.
+    void evaluateMoves(MCTSWorker& worker, bool sharedTree = false) {
+        auto node = selectMCTSNode(sharedTree);
+        node = node->expand(worker, sharedTree);
+        auto result = node->simulate(worker.g);
+        node->backpropagate(result, sharedTree);
     }
 
     std::vector<Move> getBestMoves() const {
         int visits{0};
         std::vector<Move> moves;
-        for (int i = 0; i < children.size(); ++i) {
-            const auto* c = children[i].get();
+        const int numChildren = evaluatedMoves;
+        for (int i = 0; i < numChildren; ++i) {
+            const auto* c = &children[i];
             if (c->numVisits > visits) {
                 visits = c->numVisits;
                 moves.clear();
@@ -46,80 +114,140 @@ public:
         return moves;
     }
 
-    MCTSNode(const GameState &state, MCTSNode *parent) : 
-        parent{parent}, state{state}, availableMoves{ listLegalMoves(state) } {
-        std::shuffle(availableMoves.begin(), availableMoves.end(), g);
+    // visit counts of the children of this node, in the order of their moves
+    std::vector<std::pair<Move, int>> getChildVisits() const {
+        std::vector<std::pair<Move, int>> visits;
+        const int numChildren = evaluatedMoves;
+        for (int i = 0; i < numChildren; ++i)
+            visits.emplace_back(availableMoves[i], children[i].numVisits);
+        return visits;
+    }
+
+    MCTSNode(const GameState &state, MCTSNode *parent, MCTSWorker& worker) : 
+        parent{parent}, state{state} {
+        const auto legalMoves = listLegalMoves(state);
+        numMoves = static_cast<int>(legalMoves.size());
+        availableMoves = worker.arena.allocate<Move>(legalMoves.size());
+        std::uninitialized_copy(legalMoves.begin(), legalMoves.end(), availableMoves);
+        std::shuffle(availableMoves, availableMoves + numMoves, worker.g);
     }
 
 private:
     MCTSNode* parent{nullptr};
     GameState state;
-    std::vector<Move> availableMoves;
-    std::vector<std::unique_ptr<MCTSNode>> children;
-    int evaluatedMoves{0};
-    int numVisits{0};
-    int wins{0}, losses{0};
+    Move* availableMoves{nullptr};
+    int numMoves{0};
+    MCTSNode* children{nullptr};
+    std::atomic<int> evaluatedMoves{0};
+    std::atomic<int> numVisits{0};
+    std::atomic<int> wins{0}, losses{0};
+    std::atomic<int> virtualLoss{0};
+    std::atomic_flag expanding = ATOMIC_FLAG_INIT;
     float temperature{1.4f};
 
-    static std::random_device rd;
-    static std::mt19937 g;
+    MCTSNode(const MCTSNode& other, MCTSNode* parent) :
+        parent{parent}, state{other.state}, numMoves{other.numMoves},
+        evaluatedMoves{other.evaluatedMoves.load()}, numVisits{other.numVisits.load()},
+        wins{other.wins.load()}, losses{other.losses.load()} {
+    }
+
+    void copyInto(MCTSNode* target, MCTSNode* newParent, NodeArena& arena) const {
+        new (target) MCTSNode(*this, newParent);
+        target->availableMoves = arena.allocate<Move>(numMoves);
+        std::uninitialized_copy(availableMoves, availableMoves + numMoves, target->availableMoves);
+        const int numChildren = evaluatedMoves;
+        if (numChildren > 0) {
+            target->children = arena.allocate<MCTSNode>(numMoves);
+            for (int i = 0; i < numChildren; ++i)
+                children[i].copyInto(&target->children[i], target, arena);
+        }
+    }
 
     bool isFullyExpanded() const {
-        return evaluatedMoves == availableMoves.size();
+        return evaluatedMoves.load(std::memory_order_acquire) == numMoves;
     }
 
     bool isTerminal() const {
         return isGameOver(state);
     }
 
-    MCTSNode* selectMCTSNode() {
+    MCTSNode* selectMCTSNode(bool sharedTree) {
         MCTSNode *n = this;
-        while (n->isFullyExpanded() && !n->isTerminal())
+        if (sharedTree)
+            ++n->virtualLoss;
+        while (n->isFullyExpanded() && !n->isTerminal()) {
             n = n->selectChildNode();
+            if (sharedTree)
+                ++n->virtualLoss;
+        }
         return n;
     }
 
-    float computeUCTScore() {
-        auto v = static_cast<float>(numVisits);
-        auto pv = static_cast<float>(parent->numVisits);
-        auto winPct = static_cast<float>(wins - losses) / v;
-        return winPct + temperature * std::sqrt(2 * std::log(pv) / v);
+    float computeUCTScore(float logParentVisits) const {
+        // iterations that are still running count as lost for the player choosing this node
+        const int pending = virtualLoss;
+        auto v = static_cast<float>(numVisits + pending);
+        auto winPct = static_cast<float>(wins - losses - pending) / v;
+        return winPct + temperature * std::sqrt(2 * logParentVisits / v);
     }
 
     MCTSNode* selectChildNode() const {
-        auto child = std::max_element(children.begin(), children.end(), [&](const auto& c1, const auto& c2){
-            const auto uct_c1 = c1->computeUCTScore();
-            const auto uct_c2 = c2->computeUCTScore();
+        // the parent counts the iterations still running in its children, but not the one selecting
+        int pending = 0;
+        for (int i = 0; i < numMoves; ++i)
+            pending += children[i].virtualLoss;
+        const auto logParentVisits = std::log(static_cast<float>(numVisits + pending));
+        auto child = std::max_element(children, children + numMoves, [&](const auto& c1, const auto& c2){
+            const auto uct_c1 = c1.computeUCTScore(logParentVisits);
+            const auto uct_c2 = c2.computeUCTScore(logParentVisits);
             return uct_c1 < uct_c2;
         });
-        return child->get();
+        return child;
     }
 
-    MCTSNode* expand() {
+    MCTSNode* expand(MCTSWorker& worker, bool sharedTree) {
         if (isTerminal()) {
             return this;
         }
 
-        const auto move = availableMoves[evaluatedMoves];
-        ++evaluatedMoves;
-        GameState newState = applyMove(move, state);
-        children.push_back(std::make_unique<MCTSNode>(newState, this));
-        return children.back().get();        
+        while (expanding.test_and_set(std::memory_order_acquire)) {}
+        const int index = evaluatedMoves.load(std::memory_order_relaxed);
+        if (index == numMoves) {
+            // another thread added the last child in the meantime; simulate from here
+            expanding.clear(std::memory_order_release);
+            return this;
+        }
+        if (!children)
+            children = worker.arena.allocate<MCTSNode>(numMoves);
+        GameState newState = applyMove(availableMoves[index], state);
+        auto* child = new (&children[index]) MCTSNode(newState, this, worker);
+        if (sharedTree)
+            child->virtualLoss = 1;
+        evaluatedMoves.store(index + 1, std::memory_order_release);
+        expanding.clear(std::memory_order_release);
+        return child;
     }
 
-    play::game::Player simulate() const {
+    play::game::Player simulate(play::Xoshiro256& g) const {
+        // rollouts prefer the in-place functions of the game, see gameplay/GameTraits.h
         GameState game = state;
-        play::agent::RandomPlayer<GameState, Move> player;
-        random_selector<> selector{};
-        while (!isGameOver(game)) {
-            auto moves = player.selectMoves(game);
-            const auto& move = selector(moves);
-            game = applyMove(move, game);
+        if constexpr (play::game::HasRandomPlayout<GameState>::value) {
+            while (!isGameOver(game))
+                playRandomMove(game, static_cast<std::uint32_t>(g() >> 32));
+        } else {
+            while (!isGameOver(game)) {
+                const auto moves = listLegalMoves(game);
+                const auto& move = moves[g.below(static_cast<std::uint32_t>(moves.size()))];
+                if constexpr (play::game::HasMakeMove<GameState, Move>::value)
+                    makeMove(game, move);
+                else
+                    game = applyMove(move, game);
+            }
         }
         return getWinner(game);
     }
 
-    void backpropagate(const play::game::Player &player) {
+    void backpropagate(const play::game::Player &player, bool sharedTree) {
         if (player == getActivePlayer(state).other()) {
             ++wins;
         } else if (player == getActivePlayer(state)) {
@@ -127,28 +255,162 @@ private:
         }
 
         ++numVisits;
+        if (sharedTree)
+            --virtualLoss;
         if (parent)
-            parent->backpropagate(player);
+            parent->backpropagate(player, sharedTree);
     }
 };
 
-template<class GameState, class Move>
-std::random_device MCTSNode<GameState, Move>::rd;
-
-template<class GameState, class Move>
-std::mt19937 MCTSNode<GameState, Move>::g{MCTSNode<GameState, Move>::rd()};
-
 }
 
+enum class ParallelMCTS {
+    RootParallel,
+    TreeParallel
+};
+
+/* The agent keeps its trees between calls of selectMoves. The next search starts from the
+ * node that matches the new state, usually a grandchild of the old root (our move and the
+ * reply of the opponent), so the rollouts spent on that part of the tree are carried over.
+ * States are matched by hashOf(state) and then compared with operator==, searching up to
+ * two plies below the old root.
+ *
+ * With more than one thread, the agent works in one of two modes:
+ *   RootParallel: Every thread grows its own tree with its own random number generator
+ *     and an equal share of the rollouts. The visit counts of the root children are
+ *     summed up per move before the most visited moves are selected.
+ *   TreeParallel: All threads work on one shared tree until the rollouts are used up.
+ *     Every thread has its own random number generator.
+ */
 template<class GameState, class Move, int rollouts=2000>
 class MCTSPlayer : public Agent<GameState, Move> {
 public:
+    // Without a seed, the agent draws one from the generator of the constructing thread.
+    MCTSPlayer(int threads = 1, ParallelMCTS parallelMCTS = ParallelMCTS::RootParallel, std::uint64_t seed = play::threadRandom()()) :
+        parallelMCTS{ parallelMCTS } {
+        const int numThreads = std::max(threads, 1);
+        for (int i = 0; i < numThreads; ++i)
+            workers.push_back(detail::MCTSWorker{ play::Xoshiro256{ play::splitmix64(seed) }, NodeArena{}, NodeArena{} });
+        if (numThreads > 1)
+            pool = std::make_unique<play::ThreadPool>(numThreads - 1);
+        const bool separateTrees = numThreads > 1 && parallelMCTS == ParallelMCTS::RootParallel;
+        roots.resize(separateTrees ? workers.size() : 1, nullptr);
+    }
+
+    MCTSPlayer(const MCTSPlayer&) = delete;
+    MCTSPlayer& operator=(const MCTSPlayer&) = delete;
+
+    ~MCTSPlayer() override {
+        for (auto* root : roots) {
+            if (root)
+                Node::destroyTree(root);
+        }
+    }
+
     std::vector<Move> selectMoves(const GameState& state) override {
-        MCTSNode<GameState, Move> root{ state };
-        for (int i = 0; i < rollouts; ++i) {
-            root.evaluateMoves();
+        reusedVisits = 0;
+        if (workers.size() == 1) {
+            auto& worker = workers.front();
+            auto* root = prepareRoot(roots.front(), state, 0, 1);
+            for (int i = 0; i < rollouts; ++i) {
+                root->evaluateMoves(worker);
+            }
+            return root->getBestMoves();
         }
-        return root.getBestMoves();
+
+        if (parallelMCTS == ParallelMCTS::TreeParallel)
+            return growSharedTree(state);
+
+        const int numTrees = static_cast<int>(workers.size());
+        std::vector<std::future<std::vector<std::pair<Move, int>>>> helpers;
+        for (int i = 1; i < numTrees; ++i)
+            helpers.push_back(pool->submit([this, &state, i, numTrees] { return growTree(state, i, numTrees); }));
+        auto visits = growTree(state, 0, numTrees);
+        for (auto& helper : helpers) {
+            for (const auto& [move, count] : helper.get()) {
+                auto merged = std::find_if(visits.begin(), visits.end(), [&](const auto& v) { return moveIndex(v.first, state) == moveIndex(move, state); });
+                if (merged != visits.end())
+                    merged->second += count;
+                else
+                    visits.emplace_back(move, count);
+            }
+        }
+        return mostVisitedMoves(visits);
+    }
+
+    // visits of the roots of the last search that were carried over from the search before
+    int reusedRollouts() const { return reusedVisits; }
+
+private:
+    using Node = detail::MCTSNode<GameState, Move>;
+
+    ParallelMCTS parallelMCTS{ ParallelMCTS::RootParallel };
+    std::vector<detail::MCTSWorker> workers;
+    std::unique_ptr<play::ThreadPool> pool;
+    std::vector<Node*> roots; // one per tree, kept for the next search
+    std::atomic<int> reusedVisits{ 0 };
+
+    /* Replaces root by the node for state from the old tree, or by a new node if the old
+     * tree does not contain the state. The kept subtree is copied into the spare arena of
+     * the first worker, which then becomes its arena; the arenas of the workers
+     * [firstWorker, lastWorker) that held the old tree are reset.
+     */
+    Node* prepareRoot(Node*& root, const GameState& state, std::size_t firstWorker, std::size_t lastWorker) {
+        auto& home = workers[firstWorker];
+        home.spareArena.reset();
+        Node* kept = nullptr;
+        if (root) {
+            if (const auto* match = root->findState(state, hashOf(state), 2))
+                kept = match->copyTree(home.spareArena);
+            Node::destroyTree(root);
+        }
+        for (auto i = firstWorker; i < lastWorker; ++i)
+            workers[i].arena.reset();
+        std::swap(home.arena, home.spareArena);
+        if (kept)
+            reusedVisits += kept->getNumVisits();
+        root = kept ? kept : Node::createRoot(state, home);
+        return root;
+    }
+
+    std::vector<Move> growSharedTree(const GameState& state) {
+        auto* root = prepareRoot(roots.front(), state, 0, workers.size());
+        std::atomic<int> startedRollouts{ 0 };
+        const auto work = [&](detail::MCTSWorker& worker) {
+            while (startedRollouts.fetch_add(1, std::memory_order_relaxed) < rollouts)
+                root->evaluateMoves(worker, true);
+        };
+        std::vector<std::future<void>> helpers;
+        for (std::size_t i = 1; i < workers.size(); ++i)
+            helpers.push_back(pool->submit([&, i] { work(workers[i]); }));
+        work(workers.front());
+        for (auto& helper : helpers)
+            helper.get();
+        return root->getBestMoves();
+    }
+
+    std::vector<std::pair<Move, int>> growTree(const GameState& state, int tree, int numTrees) {
+        auto& worker = workers[tree];
+        auto* root = prepareRoot(roots[tree], state, static_cast<std::size_t>(tree), static_cast<std::size_t>(tree) + 1);
+        const int treeRollouts = rollouts / numTrees + (tree < rollouts % numTrees ? 1 : 0);
+        for (int i = 0; i < treeRollouts; ++i)
+            root->evaluateMoves(worker);
+        return root->getChildVisits();
+    }
+
+    static std::vector<Move> mostVisitedMoves(const std::vector<std::pair<Move, int>>& visits) {
+        int maxVisits{0};
+        std::vector<Move> moves;
+        for (const auto& [move, count] : visits) {
+            if (count > maxVisits) {
+                maxVisits = count;
+                moves.clear();
+                moves.push_back(move);
+            } else if (count == maxVisits) {
+                moves.push_back(move);
+            }
+        }
+        return moves;
     }
 };
 
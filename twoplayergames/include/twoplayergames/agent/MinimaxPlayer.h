@@ -6,66 +6,324 @@
 #define AGENT_MINIMAX_PLAYER_H
 
 #include "Agent.h"
+#include "MoveOrdering.h"
+#include "TranspositionTable.h"
 #include "../gameplay/Player.h"
 #include "../gameplay/GameStateEvaluator.h"
+#include "../gameplay/GameTraits.h"
+#include "../ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <utility>
 #include <vector>
 
 namespace play::agent {
 
-template<class GameState, class Move, class EvaluatorType = play::game::BasicIntEvaluator<GameState>>
+enum class ParallelSearch {
+    RootSplitting,
+    LazySMP
+};
+
+template<class GameState, class Move, class EvaluatorType = play::game::BasicIntEvaluator<GameState>, class OrderingType = HeuristicMoveOrdering<GameState, Move>>
 class MinimaxPlayer : public Agent<GameState, Move> {
 public:
-    MinimaxPlayer(int maxDepth = -1) : maxDepth{ maxDepth } {
-        evaluator = std::make_unique<EvaluatorType>();
+    /* With more than one thread, all threads share one lock-free transposition table, while
+     * every thread has its own evaluator and move ordering. The threads cooperate in one of
+     * two ways:
+     *   RootSplitting: The first root move is searched alone (young brothers wait), the
+     *     remaining ones are distributed over the threads, with the best value found so far
+     *     shared as an atomic alpha bound.
+     *   LazySMP: The calling thread searches the root as in a single-threaded search. The
+     *     helper threads search the same root in different move orders, every second one a
+     *     ply deeper, and only contribute through the shared transposition table. This keeps
+     *     all threads busy even if there are fewer root moves than threads.
+     */
+    MinimaxPlayer(int maxDepth = -1, std::size_t transpositionTableMB = 16, int threads = 1, ParallelSearch parallelSearch = ParallelSearch::RootSplitting) :
+        maxDepth{ maxDepth }, parallelSearch{ parallelSearch }, table{ transpositionTableMB } {
+        const int numSearchers = std::max(threads, 1);
+        for (int i = 0; i < numSearchers; ++i)
+            searchers.push_back(std::make_unique<Searcher>(*this, i > 0 && parallelSearch == ParallelSearch::LazySMP));
+        if (numSearchers > 1)
+            pool = std::make_unique<play::ThreadPool>(numSearchers - 1);
+    }
+
+    /* Iterative deepening: search with depth 1, 2, 3, ... (up to maxDepth, if given) and
+     * return the best moves of the last iteration that finished within the time budget.
+     * The first iteration is always completed, so there is a move even for tiny budgets.
+     */
+    MinimaxPlayer(std::chrono::milliseconds timeBudget, int maxDepth = -1, std::size_t transpositionTableMB = 16, int threads = 1, ParallelSearch parallelSearch = ParallelSearch::RootSplitting) :
+        MinimaxPlayer(maxDepth, transpositionTableMB, threads, parallelSearch) {
+        this->timeBudget = timeBudget;
     }
 
     std::vector<Move> selectMoves(const GameState& game) override {
-        std::vector<Move> bestMoves;
-        int bestValue = evaluator->lowerBound();
-        int alpha = evaluator->lowerBound();
-        
-        const auto legalMoves = listLegalMoves(game);
-        for (const auto& move : legalMoves) {
-            GameState state = applyMove(move, game);
-            int value = -evaluateGame(state, maxDepth, alpha, evaluator->upperBound());
-            if (value > bestValue) {
-                bestValue = value;
-                bestMoves.clear();
-                bestMoves.push_back(move);
-            } else if (value == bestValue) {
-                bestMoves.push_back(move);
-            }
+        table.newSearch();
+        for (auto& searcher : searchers)
+            searcher->newSearch();
+        auto legalMoves = listLegalMoves(game);
+        searchers.front()->ordering.orderMoves(legalMoves, game, 0, noMoveIndex);
+        std::vector<RootMove> rootMoves;
+        for (const auto& move : legalMoves)
+            rootMoves.push_back(RootMove{ move, lowerBound() });
+
+        if (timeBudget.count() <= 0) {
+            searchRoot(game, maxDepth, rootMoves);
+            return bestMovesOf(rootMoves);
         }
 
+        deadline = std::chrono::steady_clock::now() + timeBudget;
+        std::vector<Move> bestMoves;
+        for (int depth = 1; maxDepth < 0 || depth <= maxDepth; ++depth) {
+            canAbort = depth > 1;
+            if (!searchRoot(game, depth, rootMoves))
+                break;
+            bestMoves = bestMovesOf(rootMoves);
+            if (!reachedDepthLimit())
+                break; // every line was searched to the end of the game, deeper iterations can not change the result
+            // the best moves of this iteration are searched first in the next one
+            std::stable_sort(rootMoves.begin(), rootMoves.end(), [](const RootMove& m1, const RootMove& m2) { return m1.value > m2.value; });
+        }
+        canAbort = false;
         return bestMoves;
     }
 
+    // number of nodes visited by the last call of selectMoves
+    unsigned long long nodesSearched() const {
+        unsigned long long nodes = 0;
+        for (const auto& searcher : searchers)
+            nodes += searcher->nodes;
+        return nodes;
+    }
+
 private:
+    struct RootMove {
+        Move move;
+        int value;
+    };
+
+    class Searcher;
+
     int maxDepth{ -1 };
-    std::unique_ptr<EvaluatorType> evaluator;
-
-    template<class EvalType>
-    EvalType evaluateGame(const GameState& game, int depth, EvalType alpha, EvalType beta) {
-        if (depth == 0 || isGameOver(game)) {
-            return evaluator->evaluateGameState(game);
-        } else {
-            if (depth > 0)
-                --depth;
-            const auto legal = listLegalMoves(game);
-            EvalType bestValue = evaluator->lowerBound();
-            for (const auto& move : legal) {
-                GameState state = applyMove(move, game);
-                EvalType value = -evaluateGame(state, depth, -beta, -alpha);
-                bestValue = std::max(bestValue, value);
-                alpha = std::max(alpha, bestValue);
-                if (alpha >= beta)
-                    return bestValue;
+    ParallelSearch parallelSearch{ ParallelSearch::RootSplitting };
+    TranspositionTable<int> table;
+    std::vector<std::unique_ptr<Searcher>> searchers;
+    std::unique_ptr<play::ThreadPool> pool;
+
+    std::chrono::milliseconds timeBudget{ 0 };
+    std::chrono::steady_clock::time_point deadline{};
+    bool canAbort{ false };
+    std::atomic<bool> aborted{ false };
+    std::atomic<bool> helpersStopped{ false };
+    std::atomic<int> bestRootValue{ 0 };
+    std::atomic<std::size_t> nextRootMove{ 0 };
+
+    int lowerBound() const { return searchers.front()->evaluator->lowerBound(); }
+    int upperBound() const { return searchers.front()->evaluator->upperBound(); }
+
+    bool reachedDepthLimit() const {
+        // lazy SMP helpers search deeper than the iteration, their flags tell nothing about it
+        return std::any_of(searchers.begin(), searchers.end(), [](const auto& searcher) { return !searcher->isHelper && searcher->reachedDepthLimit; });
+    }
+
+    bool searchRoot(const GameState& game, int depth, std::vector<RootMove>& rootMoves) {
+        aborted = false;
+        bestRootValue = lowerBound();
+        for (auto& searcher : searchers)
+            searcher->reachedDepthLimit = false;
+        if (rootMoves.empty())
+            return true;
+        if (parallelSearch == ParallelSearch::LazySMP && pool)
+            return searchRootLazySMP(game, depth, rootMoves);
+
+        // the first move sets the bound for its siblings
+        searchRootMove(*searchers.front(), game, depth, rootMoves.front());
+        nextRootMove = 1;
+        std::vector<std::future<void>> helpers;
+        for (std::size_t i = 1; i < searchers.size() && i < rootMoves.size(); ++i) {
+            auto& searcher = *searchers[i];
+            helpers.push_back(pool->submit([&, depth] { searchRootMoves(searcher, game, depth, rootMoves); }));
+        }
+        searchRootMoves(*searchers.front(), game, depth, rootMoves);
+        for (auto& helper : helpers)
+            helper.get();
+        return !aborted;
+    }
+
+    bool searchRootLazySMP(const GameState& game, int depth, std::vector<RootMove>& rootMoves) {
+        helpersStopped = false;
+        std::vector<std::future<void>> helpers;
+        for (std::size_t i = 1; i < searchers.size(); ++i) {
+            auto& searcher = *searchers[i];
+            helpers.push_back(pool->submit([&, depth, i] { helpSearchRoot(searcher, game, depth, rootMoves, i); }));
+        }
+        for (auto& rootMove : rootMoves) {
+            searchRootMove(*searchers.front(), game, depth, rootMove);
+            if (aborted)
+                break;
+        }
+        helpersStopped = true;
+        for (auto& helper : helpers)
+            helper.get();
+        return !aborted;
+    }
+
+    void helpSearchRoot(Searcher& searcher, const GameState& game, int depth, const std::vector<RootMove>& rootMoves, std::size_t helperIndex) {
+        // stagger the depths and start at different root moves, so the helpers fill different parts of the table
+        if (depth > 0)
+            depth += static_cast<int>(helperIndex % 2);
+        do {
+            for (std::size_t i = 0; i < rootMoves.size() && !searcher.isStopped(); ++i) {
+                const auto& rootMove = rootMoves[(i + helperIndex) % rootMoves.size()];
+                GameState state = applyMove(rootMove.move, game);
+                searcher.evaluateGame(state, depth, lowerBound(), upperBound(), 1);
+            }
+            ++depth;
+        } while (depth > 0 && !searcher.isStopped());
+    }
+
+    void searchRootMoves(Searcher& searcher, const GameState& game, int depth, std::vector<RootMove>& rootMoves) {
+        for (auto i = nextRootMove++; i < rootMoves.size() && !aborted; i = nextRootMove++)
+            searchRootMove(searcher, game, depth, rootMoves[i]);
+    }
+
+    void searchRootMove(Searcher& searcher, const GameState& game, int depth, RootMove& rootMove) {
+        // a value below the best value is only needed as a bound, values equal to the best value are exact
+        const int alpha = bestRootValue.load() - 1;
+        GameState state = applyMove(rootMove.move, game);
+        const int value = -searcher.evaluateGame(state, depth, -upperBound(), -alpha, 1);
+        if (aborted)
+            return;
+        rootMove.value = value;
+        int best = bestRootValue.load();
+        while (value > best && !bestRootValue.compare_exchange_weak(best, value)) {}
+    }
+
+    std::vector<Move> bestMovesOf(const std::vector<RootMove>& rootMoves) const {
+        std::vector<Move> bestMoves;
+        int bestValue = lowerBound();
+        for (const auto& rootMove : rootMoves) {
+            if (rootMove.value > bestValue) {
+                bestValue = rootMove.value;
+                bestMoves.clear();
+                bestMoves.push_back(rootMove.move);
+            } else if (rootMove.value == bestValue) {
+                bestMoves.push_back(rootMove.move);
             }
-            return bestValue;
         }
+        return bestMoves;
     }
-};
 
+    // The state of the search that is private to one thread.
+    class Searcher {
+    public:
+        Searcher(MinimaxPlayer& player, bool isHelper) :
+            player{ player }, isHelper{ isHelper }, evaluator{ std::make_unique<EvaluatorType>() } {
+        }
+
+        void newSearch() {
+            ordering.newSearch();
+            nodes = 0;
+        }
+
+        bool isStopped() const {
+            return player.aborted || (isHelper && player.helpersStopped);
+        }
+
+        /* Negamax with alpha-beta pruning. If the game provides makeMove and unmakeMove, the
+         * moves are applied to game in place and taken back before returning, otherwise every
+         * child is a copy from applyMove.
+         */
+        template<class EvalType>
+        EvalType evaluateGame(GameState& game, int depth, EvalType alpha, EvalType beta, int ply) {
+            if (timeIsUp())
+                return EvalType{};
+            if (isGameOver(game)) {
+                return evaluator->evaluateGameState(game);
+            } else if (depth == 0) {
+                reachedDepthLimit = true;
+                return evaluator->evaluateGameState(game);
+            } else {
+                const auto key = hashOf(game);
+                const int remainingDepth = depth < 0 ? TranspositionEntry<int>::unboundedDepth : depth;
+                std::uint8_t hashMove = noMoveIndex;
+                bool usedLimitedEntry = false;
+                if (TranspositionEntry<int> entry; player.table.probe(key, entry)) {
+                    hashMove = entry.bestMove;
+                    if (entry.depth >= remainingDepth) {
+                        // the stored value may stem from a depth-limited search
+                        usedLimitedEntry = entry.depth != TranspositionEntry<int>::unboundedDepth;
+                        if (entry.bound == Bound::Exact || (entry.bound == Bound::Lower && entry.value >= beta) || (entry.bound == Bound::Upper && entry.value <= alpha)) {
+                            reachedDepthLimit = reachedDepthLimit || usedLimitedEntry;
+                            return entry.value;
+                        } else if (entry.bound == Bound::Lower)
+                            alpha = std::max(alpha, entry.value);
+                        else
+                            beta = std::min(beta, entry.value);
+                    }
+                }
+
+                const EvalType windowAlpha = alpha;
+                const bool depthLimitReachedBefore = reachedDepthLimit;
+                reachedDepthLimit = usedLimitedEntry;
+                const int nodeDepth = depth;
+                if (depth > 0)
+                    --depth;
+                auto legal = listLegalMoves(game);
+                ordering.orderMoves(legal, game, ply, hashMove);
+                EvalType bestValue = evaluator->lowerBound();
+                std::size_t bestIndex = 0;
+                for (std::size_t i = 0; i < legal.size(); ++i) {
+                    EvalType value;
+                    if constexpr (play::game::HasMakeMove<GameState, Move>::value) {
+                        makeMove(game, legal[i]);
+                        value = -evaluateGame(game, depth, -beta, -alpha, ply + 1);
+                        unmakeMove(game, legal[i]);
+                    } else {
+                        GameState state = applyMove(legal[i], game);
+                        value = -evaluateGame(state, depth, -beta, -alpha, ply + 1);
+                    }
+                    if (isStopped())
+                        return EvalType{};
+                    if (value > bestValue) {
+                        bestValue = value;
+                        bestIndex = i;
+                    }
+                    alpha = std::max(alpha, bestValue);
+                    if (alpha >= beta) {
+                        ordering.updateOnCutoff(legal[i], game, ply, nodeDepth);
+                        break;
+                    }
+                }
+
+                const auto bound = bestValue <= windowAlpha ? Bound::Upper : (bestValue >= beta ? Bound::Lower : Bound::Exact);
+                // a subtree that ended in game-over states everywhere is valid for any depth
+                const int storedDepth = reachedDepthLimit ? remainingDepth : TranspositionEntry<int>::unboundedDepth;
+                player.table.store(key, bestValue, storedDepth, bound, static_cast<std::uint8_t>(moveIndex(legal[bestIndex], game)));
+                reachedDepthLimit = reachedDepthLimit || depthLimitReachedBefore;
+                return bestValue;
+            }
+        }
+
+        MinimaxPlayer& player;
+        const bool isHelper;
+        std::unique_ptr<EvaluatorType> evaluator;
+        OrderingType ordering;
+        bool reachedDepthLimit{ false };
+        unsigned long long nodes{ 0 };
+
+    private:
+        bool timeIsUp() {
+            // reading the clock is not free, so it is only done every 1024 nodes
+            if ((++nodes & 1023) == 0 && player.canAbort && std::chrono::steady_clock::now() >= player.deadline)
+                player.aborted = true;
+            return isStopped();
+        }
+    };
+};
 }
 
 #endif
@@ -0,0 +1,127 @@
+/* *********************************************************** *
+ * MoveOrdering.h
+ * *********************************************************** */
+
+#ifndef AGENT_MOVE_ORDERING_H
+#define AGENT_MOVE_ORDERING_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace play::agent {
+
+/* Move ordering policies for the alpha-beta search of the MinimaxPlayer.
+ * A policy sorts the legal moves of a node (the list returned by listLegalMoves, e.g. a
+ * std::vector or a play::game::MoveList) before they are searched and is told about
+ * every move that caused a beta cutoff. Moves are identified by the game-provided
+ * function int moveIndex(const Move&, const GameState&), which has to return a small
+ * non-negative number that is unique among the moves of a position.
+ */
+
+inline constexpr std::uint8_t noMoveIndex = std::numeric_limits<std::uint8_t>::max();
+
+// Searches the moves in the order of listLegalMoves; only the best move from the transposition table is moved to the front.
+template<class GameState, class Move>
+class GeneratedMoveOrdering {
+public:
+    void newSearch() {}
+
+    template<class MoveContainer>
+    void orderMoves(MoveContainer& moves, const GameState& state, int /*ply*/, std::uint8_t hashMove) {
+        for (std::size_t i = 0; i < moves.size(); ++i) {
+            if (moveIndex(moves[i], state) == hashMove) {
+                std::rotate(moves.begin(), moves.begin() + i, moves.begin() + i + 1);
+                break;
+            }
+        }
+    }
+
+    void updateOnCutoff(const Move& /*move*/, const GameState& /*state*/, int /*ply*/, int /*depth*/) {}
+};
+
+/* Orders moves by
+ *   1. the best move from the transposition table,
+ *   2. two killer moves per ply (moves that recently caused a cutoff in a sibling node),
+ *   3. the history table (how often and how deep a move caused cutoffs in the whole search),
+ *   4. the static prior of the game, int movePriority(const Move&, const GameState&),
+ *      e.g. center columns first in Connect Four.
+ */
+template<class GameState, class Move>
+class HeuristicMoveOrdering {
+public:
+    void newSearch() {
+        killers.clear();
+        // keep some knowledge from the last search, but let new cutoffs dominate
+        for (auto& h : history)
+            h /= 2;
+    }
+
+    template<class MoveContainer>
+    void orderMoves(MoveContainer& moves, const GameState& state, int ply, std::uint8_t hashMove) {
+        const auto killersOfPly = ply < static_cast<int>(killers.size()) ? killers[ply] : noKillers;
+        scores.resize(moves.size());
+        for (std::size_t i = 0; i < moves.size(); ++i) {
+            const auto index = moveIndex(moves[i], state);
+            long long score = 0;
+            if (index == hashMove)
+                score = hashMoveScore;
+            else if (index == killersOfPly[0])
+                score = killerScore + 1;
+            else if (index == killersOfPly[1])
+                score = killerScore;
+            else
+                score = historyOf(index);
+            scores[i] = score * priorRange + movePriority(moves[i], state);
+        }
+        // insertion sort: the lists are short, and it keeps the generated order for equal scores
+        for (std::size_t i = 1; i < moves.size(); ++i) {
+            for (std::size_t j = i; j > 0 && scores[j - 1] < scores[j]; --j) {
+                std::swap(scores[j - 1], scores[j]);
+                std::swap(moves[j - 1], moves[j]);
+            }
+        }
+    }
+
+    void updateOnCutoff(const Move& move, const GameState& state, int ply, int depth) {
+        const auto index = static_cast<std::uint8_t>(moveIndex(move, state));
+        if (ply >= static_cast<int>(killers.size()))
+            killers.resize(ply + 1, noKillers);
+        auto& killersOfPly = killers[ply];
+        if (killersOfPly[0] != index) {
+            killersOfPly[1] = killersOfPly[0];
+            killersOfPly[0] = index;
+        }
+        if (index >= history.size())
+            history.resize(index + 1, 0);
+        history[index] += depth > 0 ? depth * depth : 1;
+        if (history[index] > maxHistory) {
+            for (auto& h : history)
+                h /= 2;
+        }
+    }
+
+private:
+    using Killers = std::array<std::uint8_t, 2>;
+    static constexpr Killers noKillers{ noMoveIndex, noMoveIndex };
+    static constexpr long long maxHistory = 1 << 20;
+    static constexpr long long killerScore = maxHistory + 1;
+    static constexpr long long hashMoveScore = killerScore + 2;
+    static constexpr long long priorRange = 1 << 16; // movePriority has to stay within +-priorRange/2
+
+    std::vector<Killers> killers;
+    std::vector<long long> history;
+    std::vector<long long> scores;
+
+    long long historyOf(int index) const {
+        return index < static_cast<int>(history.size()) ? history[index] : 0;
+    }
+};
+
+}
+
+#endif
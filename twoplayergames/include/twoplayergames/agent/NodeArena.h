@@ -0,0 +1,90 @@
+/* *********************************************************** *
+ * NodeArena.h
+ * *********************************************************** */
+
+#ifndef AGENT_NODE_ARENA_H
+#define AGENT_NODE_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace play::agent {
+
+/* Bump allocator for search trees.
+ * Memory is handed out from large blocks by advancing an offset. Single objects are never
+ * freed; reset() rewinds the arena in O(1) and keeps the blocks for the next search, so a
+ * search that fits into the blocks of the previous one does not allocate at all.
+ * The arena does not run destructors; the owner of the objects has to do that if needed.
+ * An arena must only be used by one thread at a time.
+ */
+class NodeArena {
+public:
+    explicit NodeArena(std::size_t blockSize = 1 << 20) : blockSize{ blockSize } {}
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+    NodeArena(NodeArena&&) = default;
+    NodeArena& operator=(NodeArena&&) = default;
+
+    // uninitialized, suitably aligned memory for count objects of type T
+    template<class T>
+    T* allocate(std::size_t count = 1) {
+        return static_cast<T*>(allocateBytes(count * sizeof(T), alignof(T)));
+    }
+
+    template<class T, class... Args>
+    T* create(Args&&... args) {
+        return new (allocate<T>()) T(std::forward<Args>(args)...);
+    }
+
+    void reset() {
+        currentBlock = 0;
+        offset = 0;
+    }
+
+    std::size_t numBlocks() const { return blocks.size(); }
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> memory;
+        std::size_t size;
+    };
+
+    std::size_t blockSize;
+    std::vector<Block> blocks;
+    std::size_t currentBlock{ 0 };
+    std::size_t offset{ 0 };
+
+    void* allocateBytes(std::size_t bytes, std::size_t alignment) {
+        while (true) {
+            if (currentBlock < blocks.size()) {
+                auto& block = blocks[currentBlock];
+                const auto base = reinterpret_cast<std::uintptr_t>(block.memory.get());
+                const std::size_t start = (base + offset + alignment - 1) / alignment * alignment - base;
+                if (start + bytes <= block.size) {
+                    offset = start + bytes;
+                    return block.memory.get() + start;
+                }
+                if (currentBlock + 1 < blocks.size()) {
+                    ++currentBlock;
+                    offset = 0;
+                    continue;
+                }
+            }
+            // requests larger than a block get a block of their own
+            const std::size_t size = std::max(blockSize, bytes + alignment);
+            blocks.push_back(Block{ std::make_unique<std::byte[]>(size), size });
+            currentBlock = blocks.size() - 1;
+            offset = 0;
+        }
+    }
+};
+
+}
+
+#endif
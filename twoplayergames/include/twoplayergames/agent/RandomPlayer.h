@@ -13,7 +13,8 @@ template<class GameState, class Move>
 class RandomPlayer : public Agent<GameState, Move> {
 public:
     std::vector<Move> selectMoves(const GameState& state) override {
-        return listLegalMoves(state);
+        const auto legalMoves = listLegalMoves(state);
+        return std::vector<Move>(legalMoves.begin(), legalMoves.end());
     }
 };
 
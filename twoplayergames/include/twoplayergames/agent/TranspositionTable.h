@@ -0,0 +1,162 @@
+/* *********************************************************** *
+ * TranspositionTable.h
+ * *********************************************************** */
+
+#ifndef AGENT_TRANSPOSITION_TABLE_H
+#define AGENT_TRANSPOSITION_TABLE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace play::agent {
+
+enum class Bound : std::uint8_t {
+    Exact,
+    Lower,
+    Upper
+};
+
+template<class Value>
+struct TranspositionEntry {
+    static constexpr std::int16_t unboundedDepth = std::numeric_limits<std::int16_t>::max();
+    static constexpr std::uint8_t noMove = std::numeric_limits<std::uint8_t>::max();
+
+    std::uint64_t key{ 0 };
+    Value value{};
+    std::int16_t depth{ -1 };     // remaining search depth, unboundedDepth for searches to the end of the game
+    Bound bound{ Bound::Exact };
+    std::uint8_t bestMove{ noMove }; // moveIndex of the best move
+    std::uint8_t generation{ 0 };
+
+    bool isEmpty() const { return depth < 0; }
+};
+
+template<class Value>
+class TranspositionTable {
+    /* Fixed-size hash table of search results that can be shared by several search threads.
+     * Entries are grouped in buckets of two. The first slot of a bucket keeps the deepest
+     * result of the current search (results of earlier searches are always replaced), the
+     * second slot always takes the most recent result that was not stored in the first slot.
+     *
+     * The table does not use locks: every slot is a pair of 64-bit words, the packed entry
+     * data and the key XOR the data. Both words are written and read independently; if
+     * another thread wrote one of them in between, the XOR check fails and the slot reads as
+     * a different position, so a torn entry is never returned.
+     */
+    static_assert(std::is_integral_v<Value> && sizeof(Value) <= 4, "entries pack the value into 32 bits");
+public:
+    using Entry = TranspositionEntry<Value>;
+
+    explicit TranspositionTable(std::size_t sizeInMegabytes) :
+        m_buckets(numBucketsFor(sizeInMegabytes)) {
+    }
+
+    // Copies the entry for the key to entry and returns true, if the table contains the key.
+    bool probe(std::uint64_t key, Entry& entry) const {
+        if (m_buckets.empty())
+            return false;
+        for (const auto& slot : bucket(key)) {
+            const auto data = slot.data.load(std::memory_order_relaxed);
+            const auto check = slot.keyXorData.load(std::memory_order_relaxed);
+            if (data != 0 && (check ^ data) == key) {
+                entry = unpack(key, data);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(std::uint64_t key, Value value, int depth, Bound bound, std::uint8_t bestMove) {
+        if (m_buckets.empty())
+            return;
+        auto& slots = bucket(key);
+        const auto generation = static_cast<std::uint8_t>(m_generation.load(std::memory_order_relaxed) & generationMask);
+        const auto deepestData = slots[0].data.load(std::memory_order_relaxed);
+        const auto deepestKey = slots[0].keyXorData.load(std::memory_order_relaxed) ^ deepestData;
+        const auto deepest = unpack(deepestKey, deepestData);
+        auto& target = (deepest.isEmpty() || deepest.key == key || deepest.generation != generation || depth >= deepest.depth) ? slots[0] : slots[1];
+
+        Entry entry;
+        entry.value = value;
+        entry.depth = static_cast<std::int16_t>(depth);
+        entry.bound = bound;
+        entry.bestMove = bestMove;
+        entry.generation = generation;
+        const auto data = pack(entry);
+        target.data.store(data, std::memory_order_relaxed);
+        target.keyXorData.store(key ^ data, std::memory_order_relaxed);
+    }
+
+    void newSearch() { m_generation.fetch_add(1, std::memory_order_relaxed); }
+
+    void clear() {
+        for (auto& slots : m_buckets) {
+            for (auto& slot : slots) {
+                slot.data.store(0, std::memory_order_relaxed);
+                slot.keyXorData.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::size_t size() const { return m_buckets.size() * 2; }
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> data{ 0 };
+        std::atomic<std::uint64_t> keyXorData{ 0 };
+    };
+    using Bucket = std::array<Slot, 2>;
+
+    /* data layout: value (32 bits) | depth + 1 (16 bits) | best move (8 bits) | generation (6 bits) | bound (2 bits)
+     * The generation wraps around after 64 searches, so an entry from 64, 128, ... searches
+     * ago looks current to store(). This is intended: such an entry only keeps the first slot
+     * of its bucket until a result at least as deep arrives (the second slot still takes the
+     * new results), and probe() checks the full key either way, so the wrap costs a little
+     * table space and never gives a wrong result.
+     */
+    static constexpr unsigned generationMask = 0x3f;
+
+    std::vector<Bucket> m_buckets;
+    std::atomic<unsigned> m_generation{ 0 };
+
+    static std::size_t numBucketsFor(std::size_t sizeInMegabytes) {
+        const std::size_t bytes = sizeInMegabytes * 1024 * 1024;
+        if (bytes < sizeof(Bucket))
+            return 0;
+        std::size_t numBuckets = 1;
+        while (numBuckets * 2 * sizeof(Bucket) <= bytes)
+            numBuckets *= 2;
+        return numBuckets;
+    }
+
+    static std::uint64_t pack(const Entry& entry) {
+        const auto value = static_cast<std::uint32_t>(static_cast<std::int32_t>(entry.value));
+        return (std::uint64_t{ value } << 32)
+            | (std::uint64_t{ static_cast<std::uint16_t>(entry.depth + 1) } << 16)
+            | (std::uint64_t{ entry.bestMove } << 8)
+            | (std::uint64_t{ entry.generation } << 2)
+            | static_cast<std::uint64_t>(entry.bound);
+    }
+
+    static Entry unpack(std::uint64_t key, std::uint64_t data) {
+        Entry entry;
+        entry.key = key;
+        entry.value = static_cast<Value>(static_cast<std::int32_t>(static_cast<std::uint32_t>(data >> 32)));
+        entry.depth = static_cast<std::int16_t>(static_cast<int>((data >> 16) & 0xffff) - 1);
+        entry.bestMove = static_cast<std::uint8_t>((data >> 8) & 0xff);
+        entry.generation = static_cast<std::uint8_t>((data >> 2) & generationMask);
+        entry.bound = static_cast<Bound>(data & 0x3);
+        return entry;
+    }
+
+    Bucket& bucket(std::uint64_t key) { return m_buckets[key & (m_buckets.size() - 1)]; }
+    const Bucket& bucket(std::uint64_t key) const { return m_buckets[key & (m_buckets.size() - 1)]; }
+};
+
+}
+
+#endif
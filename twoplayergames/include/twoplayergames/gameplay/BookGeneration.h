@@ -0,0 +1,102 @@
+/* *********************************************************** *
+ * BookGeneration.h
+ * *********************************************************** */
+
+#ifndef GAMEPLAY_BOOK_GENERATION_H
+#define GAMEPLAY_BOOK_GENERATION_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace play::game {
+
+/* A position of an opening book. The key is hashOf the position, bit moveIndex(move) of
+ * bestMoves is set for every best move (so only moves with an index below 32 can be stored),
+ * and the value is the value of the position for the active player, on the scale of the
+ * agent that analysed it.
+ */
+struct BookEntry {
+    std::uint64_t key;
+    std::uint32_t bestMoves;
+    std::int32_t value;
+};
+
+static_assert(sizeof(BookEntry) == 16, "book files store the entries as they are in memory");
+
+namespace detail {
+inline constexpr char bookMagic[8] = { 'T', 'P', 'G', 'B', 'O', 'O', 'K', '1' };
+
+struct BookHeader {
+    char magic[8];
+    std::uint64_t numEntries;
+};
+
+template<class GameState>
+void collectBookPositions(const GameState& game, int depth, std::unordered_set<std::uint64_t>& seen, std::vector<GameState>& positions) {
+    if (isGameOver(game) || !seen.insert(hashOf(game)).second)
+        return;
+    if (depth > 0) {
+        for (const auto& move : listLegalMoves(game))
+            collectBookPositions(applyMove(move, game), depth - 1, seen, positions);
+    }
+    positions.push_back(game);
+}
+}
+
+/* All positions that are not over and can be reached from the root with at most depth
+ * moves, each once. A position comes after the positions below it, so an agent that keeps
+ * a transposition table finds the results of the later positions' children when it
+ * analyses the positions in this order. Positions are identified by their hash, which
+ * assumes that a game reaches a position always after the same number of moves, as in
+ * Connect Four and TicTacToe.
+ */
+template<class GameState>
+std::vector<GameState> listBookPositions(const GameState& root, int depth) {
+    std::unordered_set<std::uint64_t> seen;
+    std::vector<GameState> positions;
+    detail::collectBookPositions(root, depth, seen, positions);
+    return positions;
+}
+
+/* Analyses every position of listBookPositions(root, depth) with analyse, which returns the
+ * value of the position and its best moves as a std::pair<int, std::vector<Move>>.
+ */
+template<class GameState, class Move, class Analyse>
+std::vector<BookEntry> generateOpeningBook(const GameState& root, int depth, Analyse analyse) {
+    std::vector<BookEntry> entries;
+    for (const auto& position : listBookPositions(root, depth)) {
+        const auto [value, bestMoves] = analyse(position);
+        BookEntry entry{ hashOf(position), 0, value };
+        for (const Move& move : bestMoves) {
+            const auto index = moveIndex(move, position);
+            if (index >= 0 && index < 32)
+                entry.bestMoves |= std::uint32_t{ 1 } << index;
+        }
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+/* Writes a book file: a header with a magic number and the number of entries, followed by
+ * the entries sorted by key, all in the byte order of the writing machine.
+ */
+inline bool writeOpeningBook(const std::string& path, std::vector<BookEntry> entries) {
+    std::sort(entries.begin(), entries.end(), [](const BookEntry& e1, const BookEntry& e2) { return e1.key < e2.key; });
+    detail::BookHeader header{};
+    std::memcpy(header.magic, detail::bookMagic, sizeof(header.magic));
+    header.numEntries = entries.size();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(BookEntry)));
+    return static_cast<bool>(file);
+}
+
+}
+
+#endif
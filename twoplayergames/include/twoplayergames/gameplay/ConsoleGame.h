@@ -15,7 +15,7 @@ namespace play::game {
 template<class GameState, class Move, class... Args>
 Player playConsoleGame(play::agent::Agent<GameState, Move>* player1, play::agent::Agent<GameState, Move>* player2, Args... args) {
     GameState game = GameState::newGame(args...);
-    random_selector<> selector{};
+    random_selector<play::Xoshiro256&> selector{ play::threadRandom() };
     int round{ 1 };
     
     std::cout << game;
@@ -0,0 +1,44 @@
+/* *********************************************************** *
+ * GameTraits.h
+ * *********************************************************** */
+
+#ifndef GAMEPLAY_GAME_TRAITS_H
+#define GAMEPLAY_GAME_TRAITS_H
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace play::game {
+
+/* Compile-time detection of the optional parts of the game interface.
+ * The agents use these functions when a game provides them and fall back to the
+ * required functions otherwise.
+ */
+
+/* In-place moves:
+ *   void makeMove(GameState&, const Move&) applies a legal move to the state,
+ *   void unmakeMove(GameState&, const Move&) takes back the move last made by makeMove,
+ *     which is only required to work if the state was not over before the move.
+ */
+template<class GameState, class Move, class = void>
+struct HasMakeMove : std::false_type {};
+
+template<class GameState, class Move>
+struct HasMakeMove<GameState, Move, std::void_t<
+    decltype(makeMove(std::declval<GameState&>(), std::declval<const Move&>())),
+    decltype(unmakeMove(std::declval<GameState&>(), std::declval<const Move&>()))>> : std::true_type {};
+
+/* Random rollouts:
+ *   void playRandomMove(GameState&, std::uint32_t randomBits) plays a legal move that is
+ *     chosen uniformly by the random bits in place.
+ */
+template<class GameState, class = void>
+struct HasRandomPlayout : std::false_type {};
+
+template<class GameState>
+struct HasRandomPlayout<GameState, std::void_t<decltype(playRandomMove(std::declval<GameState&>(), std::uint32_t{}))>> : std::true_type {};
+
+}
+
+#endif
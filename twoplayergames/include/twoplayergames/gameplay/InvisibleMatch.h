@@ -14,7 +14,7 @@ namespace play::game {
 template<class GameState, class Move, class... Args>
 Player playInvisibleMatch(play::agent::Agent<GameState, Move>* player1, play::agent::Agent<GameState, Move>* player2, Args... args) {
     GameState game = GameState::newGame(args...);
-    random_selector<> selector{};
+    random_selector<play::Xoshiro256&> selector{ play::threadRandom() };
 
     while (!isGameOver(game)) {
         const auto player1Moves = player1->selectMoves(game);
@@ -0,0 +1,80 @@
+/* *********************************************************** *
+ * MoveList.h
+ * *********************************************************** */
+
+#ifndef GAMEPLAY_MOVE_LIST_H
+#define GAMEPLAY_MOVE_LIST_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace play::game {
+
+/* List of moves with a fixed capacity that lives on the stack.
+ * Games return it from listLegalMoves with the largest number of legal moves of any
+ * position as capacity, so generating moves never allocates. The interface is the part
+ * of std::vector the agents need. Moves do not have to be default constructible, but
+ * have to be trivially copyable, so the list can be copied and destroyed as a whole.
+ * Adding more moves than the capacity is undefined behaviour.
+ */
+template<class Move, std::size_t Capacity>
+class MoveList {
+    static_assert(std::is_trivially_copyable_v<Move> && std::is_trivially_destructible_v<Move>, "moves are copied as plain memory");
+public:
+    using value_type = Move;
+    using size_type = std::size_t;
+    using iterator = Move*;
+    using const_iterator = const Move*;
+
+    MoveList() = default;
+
+    MoveList(std::initializer_list<Move> moves) {
+        for (const auto& move : moves)
+            push_back(move);
+    }
+
+    void push_back(const Move& move) { new (&storage.moves[count++]) Move(move); }
+
+    template<class... Args>
+    Move& emplace_back(Args&&... args) {
+        return *new (&storage.moves[count++]) Move(std::forward<Args>(args)...);
+    }
+
+    void pop_back() { --count; }
+    void clear() { count = 0; }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    static constexpr std::size_t capacity() { return Capacity; }
+
+    Move& operator[](std::size_t i) { return storage.moves[i]; }
+    const Move& operator[](std::size_t i) const { return storage.moves[i]; }
+    Move& front() { return storage.moves[0]; }
+    const Move& front() const { return storage.moves[0]; }
+    Move& back() { return storage.moves[count - 1]; }
+    const Move& back() const { return storage.moves[count - 1]; }
+
+    Move* data() { return storage.moves; }
+    const Move* data() const { return storage.moves; }
+    iterator begin() { return storage.moves; }
+    iterator end() { return storage.moves + count; }
+    const_iterator begin() const { return storage.moves; }
+    const_iterator end() const { return storage.moves + count; }
+
+private:
+    // a union leaves the moves uninitialized until they are added
+    union Storage {
+        Storage() {}
+        Move moves[Capacity];
+    };
+
+    Storage storage;
+    std::size_t count{ 0 };
+};
+
+}
+
+#endif
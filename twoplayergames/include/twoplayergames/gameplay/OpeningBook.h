@@ -0,0 +1,144 @@
+/* *********************************************************** *
+ * OpeningBook.h
+ * *********************************************************** */
+
+#ifndef GAMEPLAY_OPENING_BOOK_H
+#define GAMEPLAY_OPENING_BOOK_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "BookGeneration.h"
+
+// POSIX systems map book files into memory, other systems read them into a buffer
+#ifndef TWOPLAYERGAMES_MAP_BOOKS
+#if defined(__unix__) || defined(__APPLE__)
+#define TWOPLAYERGAMES_MAP_BOOKS 1
+#else
+#define TWOPLAYERGAMES_MAP_BOOKS 0
+#endif
+#endif
+
+#if TWOPLAYERGAMES_MAP_BOOKS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace play::game {
+
+class OpeningBook {
+    /* Read-only view of a book file written by writeOpeningBook. On POSIX systems the file
+     * is mapped into memory instead of read, so opening a book costs nothing until positions
+     * are looked up, and the pages are shared by all processes that use the same book;
+     * elsewhere the file is read into a buffer once. Lookups are binary searches and may run
+     * on several threads at once.
+     */
+public:
+    OpeningBook() = default;
+    explicit OpeningBook(const std::string& path) { open(path); }
+    ~OpeningBook() { close(); }
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    // Opens the book file; returns false and leaves the book empty if it is no valid book.
+    bool open(const std::string& path) {
+        close();
+        if (load(path))
+            return true;
+        close();
+        return false;
+    }
+
+    void close() {
+#if TWOPLAYERGAMES_MAP_BOOKS
+        if (m_mapping != nullptr)
+            ::munmap(m_mapping, m_length);
+        m_mapping = nullptr;
+        m_length = 0;
+#else
+        m_buffer.clear();
+#endif
+        m_entries = nullptr;
+        m_size = 0;
+    }
+
+    bool isOpen() const { return m_entries != nullptr; }
+    std::size_t size() const { return m_size; }
+
+    // The entry of the position with the key, nullptr if the book does not contain it.
+    const BookEntry* find(std::uint64_t key) const {
+        const auto* end = m_entries + m_size;
+        const auto* entry = std::lower_bound(m_entries, end, key, [](const BookEntry& e, std::uint64_t k) { return e.key < k; });
+        return entry != end && entry->key == key ? entry : nullptr;
+    }
+
+private:
+#if TWOPLAYERGAMES_MAP_BOOKS
+    void* m_mapping{ nullptr };
+    std::size_t m_length{ 0 };
+#else
+    std::vector<BookEntry> m_buffer; // the whole file, the header takes the place of one entry
+#endif
+    const BookEntry* m_entries{ nullptr };
+    std::size_t m_size{ 0 };
+
+#if TWOPLAYERGAMES_MAP_BOOKS
+    bool load(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat status;
+        if (::fstat(fd, &status) == 0 && static_cast<std::size_t>(status.st_size) >= sizeof(detail::BookHeader)) {
+            m_length = static_cast<std::size_t>(status.st_size);
+            m_mapping = ::mmap(nullptr, m_length, PROT_READ, MAP_SHARED, fd, 0);
+            if (m_mapping == MAP_FAILED)
+                m_mapping = nullptr;
+        }
+        ::close(fd); // the mapping stays valid
+        if (m_mapping == nullptr)
+            return false;
+        // lookups jump around in the file, reading ahead does not pay off
+        ::madvise(m_mapping, m_length, MADV_RANDOM);
+        return accept(m_mapping, m_length);
+    }
+#else
+    bool load(const std::string& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+        const auto length = static_cast<std::size_t>(file.tellg());
+        if (length < sizeof(detail::BookHeader))
+            return false;
+        static_assert(sizeof(detail::BookHeader) == sizeof(BookEntry));
+        m_buffer.resize((length + sizeof(BookEntry) - 1) / sizeof(BookEntry));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(m_buffer.data()), static_cast<std::streamsize>(length));
+        return file && accept(m_buffer.data(), length);
+    }
+#endif
+
+    // checks the header of the file contents and points the entries into them
+    bool accept(const void* contents, std::size_t length) {
+        detail::BookHeader header;
+        std::memcpy(&header, contents, sizeof(header));
+        if (std::memcmp(header.magic, detail::bookMagic, sizeof(header.magic)) != 0
+            || header.numEntries != (length - sizeof(detail::BookHeader)) / sizeof(BookEntry)
+            || (length - sizeof(detail::BookHeader)) % sizeof(BookEntry) != 0)
+            return false;
+        m_entries = reinterpret_cast<const BookEntry*>(static_cast<const char*>(contents) + sizeof(detail::BookHeader));
+        m_size = header.numEntries;
+        return true;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,64 @@
+/* *********************************************************** *
+ * Perft.h
+ * *********************************************************** */
+
+#ifndef GAMEPLAY_PERFT_H
+#define GAMEPLAY_PERFT_H
+
+#include "GameTraits.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace play::game {
+
+/* Performance test of move generation: counts the leaves of the game tree below a state
+ * down to the given depth (a negative depth counts to the end of every game). A leaf is a
+ * state at the given depth or a state where the game is over, so the count for the full
+ * TicTacToe tree is the number of possible games, 255168.
+ * Uses listLegalMoves, isGameOver and makeMove/unmakeMove if the game provides them,
+ * applyMove otherwise. The counts of a game are fixed, which makes them a check for any
+ * change of the move generation.
+ */
+template<class GameState, class Move>
+std::uint64_t perft(GameState& game, int depth) {
+    if (depth == 0 || isGameOver(game))
+        return 1;
+    const auto moves = listLegalMoves(game);
+    // all children are leaves, there is no need to generate them
+    if (depth == 1)
+        return moves.size();
+    std::uint64_t leaves{ 0 };
+    for (const auto& move : moves) {
+        if constexpr (HasMakeMove<GameState, Move>::value) {
+            makeMove(game, move);
+            leaves += perft<GameState, Move>(game, depth - 1);
+            unmakeMove(game, move);
+        } else {
+            auto child = applyMove(move, game);
+            leaves += perft<GameState, Move>(child, depth - 1);
+        }
+    }
+    return leaves;
+}
+
+template<class GameState, class Move>
+std::uint64_t perft(const GameState& game, int depth) {
+    auto state = game;
+    return perft<GameState, Move>(state, depth);
+}
+
+// The leaf count below every legal move of the state, to narrow down differences between two move generators.
+template<class GameState, class Move>
+std::vector<std::pair<Move, std::uint64_t>> perftDivide(const GameState& game, int depth) {
+    std::vector<std::pair<Move, std::uint64_t>> counts;
+    if (depth == 0 || isGameOver(game))
+        return counts;
+    for (const auto& move : listLegalMoves(game))
+        counts.emplace_back(move, perft<GameState, Move>(applyMove(move, game), depth - 1));
+    return counts;
+}
+
+}
+
+#endif
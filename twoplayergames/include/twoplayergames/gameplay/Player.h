@@ -17,7 +17,7 @@ public:
         }
     }
 
-    constexpr Player(const Player& other) : m_id{ other.m_id } {}
+    constexpr Player(const Player& other) = default;
 
     bool operator==(const Player& other) const { return m_id == other.m_id; }
     bool operator!=(const Player& other) const { return !(*this == other); }
@@ -0,0 +1,146 @@
+/* *********************************************************** *
+ * Tournament.h
+ * *********************************************************** */
+
+#ifndef GAMEPLAY_TOURNAMENT_H
+#define GAMEPLAY_TOURNAMENT_H
+
+#include "InvisibleMatch.h"
+#include "Player.h"
+#include "../Random.h"
+#include "../ThreadPool.h"
+#include "../agent/Agent.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace play::game {
+
+template<class GameState, class Move>
+using AgentFactory = std::function<std::unique_ptr<play::agent::Agent<GameState, Move>>()>;
+
+enum class MatchOutcome {
+    FirstAgentWins,
+    SecondAgentWins,
+    Draw
+};
+
+struct TournamentResult {
+    int games{ 0 };
+    int firstAgentWins{ 0 };
+    int secondAgentWins{ 0 };
+    int draws{ 0 };
+};
+
+// Called after every game with the number of the game, its outcome and the standings including it.
+using TournamentProgress = std::function<void(int game, MatchOutcome outcome, const TournamentResult& standings)>;
+
+struct TournamentOptions {
+    int games{ 1000 };
+    unsigned threads{ std::max(std::thread::hardware_concurrency(), 1u) };
+    std::uint64_t seed{ 0 };
+};
+
+namespace detail {
+// win, loss and draw counts are packed into one word, so every update is one atomic add
+// and the standings handed to the progress callback are always consistent
+inline constexpr int countBits = 21;
+inline constexpr std::uint64_t countMask = (std::uint64_t{ 1 } << countBits) - 1;
+
+inline TournamentResult unpackStandings(std::uint64_t packed) {
+    TournamentResult result;
+    result.firstAgentWins = static_cast<int>(packed & countMask);
+    result.secondAgentWins = static_cast<int>((packed >> countBits) & countMask);
+    result.draws = static_cast<int>((packed >> (2 * countBits)) & countMask);
+    result.games = result.firstAgentWins + result.secondAgentWins + result.draws;
+    return result;
+}
+
+inline std::uint64_t standingsIncrement(MatchOutcome outcome) {
+    switch (outcome) {
+    case MatchOutcome::FirstAgentWins: return 1;
+    case MatchOutcome::SecondAgentWins: return std::uint64_t{ 1 } << countBits;
+    default: return std::uint64_t{ 1 } << (2 * countBits);
+    }
+}
+
+// gives the calling thread its generator back when the tournament ends, also by an exception
+class ThreadRandomGuard {
+public:
+    ThreadRandomGuard() : saved{ threadRandom() } {}
+    ~ThreadRandomGuard() { threadRandom() = saved; }
+
+    ThreadRandomGuard(const ThreadRandomGuard&) = delete;
+    ThreadRandomGuard& operator=(const ThreadRandomGuard&) = delete;
+
+private:
+    Xoshiro256 saved;
+};
+}
+
+/* Plays options.games invisible matches between two agents on options.threads threads.
+ * Agents keep state between moves, so every thread creates its own pair of agents with the
+ * factories and plays them in pairs of consecutive games: games 2 * thread and
+ * 2 * thread + 1, then the pair threads further on, and so on. The agents swap colours every
+ * game: in even games the first agent is Player 1, in odd games the second one, so every
+ * thread plays both colours equally often. Every thread seeds its generator (see Random.h)
+ * from the seed and its index before it creates its agents, so a tournament with the same
+ * seed and number of threads plays the same games; the calling thread plays too and gets
+ * its generator back afterwards. The progress callback is called from the playing threads
+ * and has to be thread-safe; at most 2^21 - 1 games are supported.
+ */
+template<class GameState, class Move, class... Args>
+TournamentResult playTournament(const AgentFactory<GameState, Move>& createFirstAgent, const AgentFactory<GameState, Move>& createSecondAgent,
+    const TournamentOptions& options, const TournamentProgress& progress, Args... args) {
+    std::atomic<std::uint64_t> standings{ 0 };
+    const int numPairs = (options.games + 1) / 2;
+    const unsigned numThreads = std::max(1u, std::min(options.threads, static_cast<unsigned>(std::max(numPairs, 1))));
+
+    const auto playGames = [&](unsigned thread) {
+        std::uint64_t threadSeed = options.seed + thread;
+        seedThreadRandom(play::splitmix64(threadSeed));
+        const auto firstAgent = createFirstAgent();
+        const auto secondAgent = createSecondAgent();
+        // the two games of a pair: 2 * pair with the first agent as Player 1, then the return game
+        const auto nextGame = [&](int game) { return game % 2 == 0 ? game + 1 : game + 2 * static_cast<int>(numThreads) - 1; };
+        for (int game = 2 * static_cast<int>(thread); game < options.games; game = nextGame(game)) {
+            const bool firstAgentStarts = game % 2 == 0;
+            const auto& winner = firstAgentStarts
+                ? playInvisibleMatch<GameState, Move>(firstAgent.get(), secondAgent.get(), args...)
+                : playInvisibleMatch<GameState, Move>(secondAgent.get(), firstAgent.get(), args...);
+            MatchOutcome outcome = MatchOutcome::Draw;
+            if (winner == Player::Player1)
+                outcome = firstAgentStarts ? MatchOutcome::FirstAgentWins : MatchOutcome::SecondAgentWins;
+            else if (winner == Player::Player2)
+                outcome = firstAgentStarts ? MatchOutcome::SecondAgentWins : MatchOutcome::FirstAgentWins;
+            const auto increment = detail::standingsIncrement(outcome);
+            const auto packed = standings.fetch_add(increment, std::memory_order_relaxed) + increment;
+            if (progress)
+                progress(game, outcome, detail::unpackStandings(packed));
+        }
+    };
+
+    std::unique_ptr<play::ThreadPool> pool;
+    std::vector<std::future<void>> helpers;
+    if (numThreads > 1) {
+        pool = std::make_unique<play::ThreadPool>(numThreads - 1);
+        for (unsigned thread = 1; thread < numThreads; ++thread)
+            helpers.push_back(pool->submit([&, thread] { playGames(thread); }));
+    }
+    {
+        const detail::ThreadRandomGuard callerRandom;
+        playGames(0);
+    }
+    for (auto& helper : helpers)
+        helper.get();
+    return detail::unpackStandings(standings.load());
+}
+
+}
+
+#endif
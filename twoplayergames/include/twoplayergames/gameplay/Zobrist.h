@@ -0,0 +1,32 @@
+/* *********************************************************** *
+ * Zobrist.h
+ * *********************************************************** */
+
+#ifndef GAMEPLAY_ZOBRIST_H
+#define GAMEPLAY_ZOBRIST_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "../Random.h"
+
+namespace play::game {
+
+/* Random keys for Zobrist hashing.
+ * A game state keeps the XOR of the keys of all (player, cell) pairs on the board, and
+ * toggles one key per placed stone, so the hash is updated in O(1) with every move.
+ * The keys are generated at compile time with splitmix64, so they are the same in
+ * every run and every build.
+ */
+template<std::size_t NumKeys>
+constexpr std::array<std::uint64_t, NumKeys> makeZobristKeys(std::uint64_t seed) {
+    std::array<std::uint64_t, NumKeys> keys{};
+    for (auto& key : keys)
+        key = play::splitmix64(seed);
+    return keys;
+}
+
+}
+
+#endif
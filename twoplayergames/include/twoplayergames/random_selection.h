@@ -4,12 +4,15 @@
 #include <random>
 #include <iterator>
 
+#include "Random.h"
+
 // Source: https://gist.github.com/cbsmith/5538174
+// The default generator is seeded from the generator of the calling thread (see Random.h).
 
-template <typename RandomGenerator = std::default_random_engine>
+template <typename RandomGenerator = play::Xoshiro256>
 struct random_selector
 {
-	random_selector(RandomGenerator g = RandomGenerator(std::random_device()()))
+	random_selector(RandomGenerator g = RandomGenerator(play::threadRandom()()))
 		: gen(g) {
 	}
 